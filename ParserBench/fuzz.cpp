@@ -0,0 +1,125 @@
+// libFuzzer entry point of the MI output parser, built by the "fuzz" target.
+// The input is split into lines and each line is parsed like the command queue does.
+// Besides memory errors the fuzzer stops when the decoders disagree:
+//  - a record the eager parser accepts must give the same tree when parsed lazily,
+//  - the visitor must accept the results the parser accepts,
+//  - UnescapeCString never writes more bytes than it reads.
+//
+// usage: ParserBenchFuzz -max_len=4096 fuzz_corpus/ corpus/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "cmd_result_parser.h"
+#include "cmd_result_schema.h"
+#include "cmd_result_visitor.h"
+#include "escape.h"
+#include "frame.h"
+#include "updated_variable.h"
+
+namespace
+{
+
+template<typename Record>
+class CheckRecords : public dbg_mi::RecordListVisitor<Record>
+{
+public:
+    CheckRecords(dbg_mi::Atom list, dbg_mi::Atom item) :
+        dbg_mi::RecordListVisitor<Record>(list, item, Record::GetSchema())
+    {
+    }
+    virtual bool OnRecord(Record &record, dbg_mi::DecodedFields const &fields, int /*index*/)
+    {
+        record.Complete(fields);
+        return true;
+    }
+};
+
+// ----------------------------------------------------------------------------
+void DecodeTuples(dbg_mi::ResultValue const &value)
+// ----------------------------------------------------------------------------
+{
+    if(value.GetType() == dbg_mi::ResultValue::Simple)
+        return;
+    for(int ii = 0; ii < value.GetTupleSize(); ++ii)
+    {
+        dbg_mi::ResultValue const &child = *value.GetTupleValueByIndex(ii);
+        if(child.GetType() != dbg_mi::ResultValue::Tuple)
+            continue;
+        dbg_mi::Frame frame;
+        frame.ParseFrame(child);
+        dbg_mi::UpdatedVariable var;
+        var.Parse(child);
+        dbg_mi::VarObjectInfo info;
+        info.Parse(child);
+        DecodeTuples(child);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void CheckLine(std::string const &line)
+// ----------------------------------------------------------------------------
+{
+    dbg_mi::RecordHeader header;
+    if(not dbg_mi::DecodeRecordHeader(line.data(), line.length(), header))
+        return;
+
+    std::string eager_line(line);
+    dbg_mi::ResultParser eager;
+    eager.SetLazy(false);
+    bool eager_parsed = eager.Parse(eager_line, header) && not eager.GetParseError();
+
+    std::string lazy_line(line);
+    dbg_mi::ResultParser lazy;
+    lazy.Parse(lazy_line, header);
+    wxString lazy_string = lazy.GetResultValue().MakeDebugString();
+    DecodeTuples(lazy.GetResultValue());
+
+    if(not eager_parsed)
+        return;
+    if(eager.GetResultValue().MakeDebugString() != lazy_string)
+        std::abort();
+
+    int start = header.class_end + 1;
+    if(start < static_cast<int>(line.length()))
+    {
+        dbg_mi::ResultVisitor visitor;
+        if(not dbg_mi::VisitValue(line.data(), line.length(), visitor, start))
+            std::abort();
+
+        CheckRecords<dbg_mi::Frame> frames(dbg_mi::Atom_stack, dbg_mi::Atom_frame);
+        dbg_mi::VisitValue(line.data(), line.length(), frames, start);
+        CheckRecords<dbg_mi::VarObjectInfo> children(dbg_mi::Atom_children, dbg_mi::Atom_child);
+        dbg_mi::VisitValue(line.data(), line.length(), children, start);
+        CheckRecords<dbg_mi::UpdatedVariable> changes(dbg_mi::Atom_changelist, dbg_mi::Atom_Unknown);
+        dbg_mi::VisitValue(line.data(), line.length(), changes, start);
+    }
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput(uint8_t const *data, size_t size)
+// ----------------------------------------------------------------------------
+{
+    char const *input = reinterpret_cast<char const*>(data);
+
+    std::vector<char> unescaped(size + 1);
+    int length = dbg_mi::UnescapeCString(input, size, unescaped.data());
+    if(length < 0 || static_cast<size_t>(length) > size)
+        std::abort();
+
+    size_t begin = 0;
+    while(begin < size)
+    {
+        char const *eol = static_cast<char const*>(std::memchr(input + begin, '\n', size - begin));
+        size_t end = eol ? eol - input : size;
+        CheckLine(std::string(input + begin, end - begin));
+        begin = end + 1;
+    }
+    return 0;
+}
@@ -0,0 +1,349 @@
+// Throughput benchmark of the MI output parser.
+// Links only the parser sources of the plugin, no SDK and no GUI (wxBase is enough).
+//
+// usage: ParserBench [-t seconds] [corpus files...]
+// Without files all the *.txt files in ./corpus are used. The lines can be raw GDB/MI output
+// or the debug log of the plugin ("output==>" lines); other lines are skipped.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <wx/arrstr.h>
+#include <wx/dir.h>
+#include <wx/init.h>
+
+#include "cmd_result_parser.h"
+#include "cmd_result_schema.h"
+#include "cmd_result_visitor.h"
+#include "escape.h"
+#include "frame.h"
+#include "updated_variable.h"
+
+// ----------------------------------------------------------------------------
+// Allocation counter, every operator new of the process is counted
+// ----------------------------------------------------------------------------
+static unsigned long long g_allocations = 0;
+
+void* operator new(size_t size)
+{
+    ++g_allocations;
+    void *p = std::malloc(size ? size : 1);
+    if(not p)
+        throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+void operator delete[](void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+
+struct Record
+{
+    std::string line;
+    dbg_mi::RecordHeader header;
+};
+typedef std::vector<Record> Records;
+
+double g_min_seconds = 1.0;
+
+// ----------------------------------------------------------------------------
+bool LoadCorpus(char const *filename, Records &records)
+// ----------------------------------------------------------------------------
+{
+    std::ifstream file(filename, std::ios::binary);
+    if(not file)
+    {
+        std::fprintf(stderr, "can't open %s\n", filename);
+        return false;
+    }
+    static char const log_prefix[] = "output==>";
+    std::string line;
+    while(std::getline(file, line))
+    {
+        if(not line.empty() && line[line.length() - 1] == '\r')
+            line.erase(line.length() - 1);
+        size_t log_pos = line.find(log_prefix);
+        if(log_pos != std::string::npos)
+            line.erase(0, log_pos + sizeof(log_prefix) - 1);
+
+        Record r;
+        if(not dbg_mi::DecodeRecordHeader(line.data(), line.length(), r.header))
+            continue;
+        r.line = line;
+        records.push_back(r);
+    }
+    return true;
+}
+
+struct Measure
+{
+    unsigned long long records;
+    unsigned long long bytes;
+    unsigned long long allocations;
+    double seconds;
+};
+
+// ----------------------------------------------------------------------------
+void Report(char const *name, Measure const &m)
+// ----------------------------------------------------------------------------
+{
+    double mb = m.bytes / (1024.0 * 1024.0);
+    std::printf("%-28s %10.0f records/s %9.2f MB/s %8.2f allocs/record\n", name,
+                m.records / m.seconds, mb / m.seconds,
+                m.records ? double(m.allocations) / m.records : 0.0);
+}
+
+// Runs 'pass' over the records until g_min_seconds have passed.
+// ----------------------------------------------------------------------------
+template<typename Pass>
+Measure Run(Records const &records, Pass pass)
+// ----------------------------------------------------------------------------
+{
+    typedef std::chrono::steady_clock Clock;
+
+    Measure m = { 0, 0, 0, 0.0 };
+    pass(records); // warm up
+    Clock::time_point start = Clock::now();
+    unsigned long long start_allocations = g_allocations;
+    do
+    {
+        m.bytes += pass(records);
+        m.records += records.size();
+        m.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    } while(m.seconds < g_min_seconds);
+    m.allocations = g_allocations - start_allocations;
+    return m;
+}
+
+// The queue copies each line once, the parser takes the copy over.
+// ----------------------------------------------------------------------------
+size_t ParseRecords(Records const &records, bool lazy)
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = 0;
+    dbg_mi::ResultParser parser;
+    parser.SetLazy(lazy);
+    for(Records::const_iterator it = records.begin(); it != records.end(); ++it)
+    {
+        std::string line(it->line);
+        parser.Parse(line, it->header);
+        bytes += it->line.length();
+    }
+    return bytes;
+}
+
+// Lazy parse and then every value is decoded, like a debug log of the result does.
+// ----------------------------------------------------------------------------
+size_t ParseAndDecode(Records const &records)
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = 0;
+    dbg_mi::ResultParser parser;
+    for(Records::const_iterator it = records.begin(); it != records.end(); ++it)
+    {
+        std::string line(it->line);
+        parser.Parse(line, it->header);
+        parser.GetResultValue().MakeDebugString();
+        bytes += it->line.length();
+    }
+    return bytes;
+}
+
+class CountingVisitor : public dbg_mi::ResultVisitor
+{
+public:
+    CountingVisitor() : m_events(0) {}
+    virtual bool OnTupleStart(dbg_mi::Span const &) { ++m_events; return true; }
+    virtual bool OnListStart(dbg_mi::Span const &) { ++m_events; return true; }
+    virtual bool OnValue(dbg_mi::Span const &, dbg_mi::Span const &) { ++m_events; return true; }
+    size_t m_events;
+};
+
+// ----------------------------------------------------------------------------
+size_t VisitRecords(Records const &records)
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = 0;
+    CountingVisitor visitor;
+    for(Records::const_iterator it = records.begin(); it != records.end(); ++it)
+    {
+        std::string const &line = it->line;
+        int start = it->header.class_end;
+        if(start < static_cast<int>(line.length()) && line[start] == ',')
+            dbg_mi::VisitValue(line.data(), line.length(), visitor, start + 1);
+        bytes += line.length();
+    }
+    return bytes;
+}
+
+template<typename Record>
+class CountingRecords : public dbg_mi::RecordListVisitor<Record>
+{
+public:
+    CountingRecords(dbg_mi::Atom list, dbg_mi::Atom item) :
+        dbg_mi::RecordListVisitor<Record>(list, item, Record::GetSchema())
+    {
+    }
+    virtual bool OnRecord(Record &record, dbg_mi::DecodedFields const &fields, int /*index*/)
+    {
+        record.Complete(fields);
+        return true;
+    }
+};
+
+// The typed decoders of the hot records: stack frames, children and var-update entries.
+// ----------------------------------------------------------------------------
+size_t DecodeTypedRecords(Records const &records)
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = 0;
+    for(Records::const_iterator it = records.begin(); it != records.end(); ++it)
+    {
+        std::string const &line = it->line;
+        int start = it->header.class_end + 1;
+        if(start >= static_cast<int>(line.length()))
+            continue;
+        CountingRecords<dbg_mi::Frame> frames(dbg_mi::Atom_stack, dbg_mi::Atom_frame);
+        CountingRecords<dbg_mi::VarObjectInfo> children(dbg_mi::Atom_children, dbg_mi::Atom_child);
+        CountingRecords<dbg_mi::UpdatedVariable> changes(dbg_mi::Atom_changelist, dbg_mi::Atom_Unknown);
+        if(line.find("stack=[", start) != std::string::npos)
+            dbg_mi::VisitValue(line.data(), line.length(), frames, start);
+        else if(line.find("children=[", start) != std::string::npos)
+            dbg_mi::VisitValue(line.data(), line.length(), children, start);
+        else if(line.find("changelist=[", start) != std::string::npos)
+            dbg_mi::VisitValue(line.data(), line.length(), changes, start);
+        else
+            continue;
+        bytes += line.length();
+    }
+    return bytes;
+}
+
+// A value of 'size' bytes where about every fifth char is escaped, as a ^done record.
+// ----------------------------------------------------------------------------
+Record MakeEscapedRecord(size_t size)
+// ----------------------------------------------------------------------------
+{
+    static char const *const escapes[] = { "\\\"", "\\\\", "\\n", "\\t", "\\033" };
+    Record r;
+    r.line = "10000000001^done,value=\"";
+    unsigned seed = 1;
+    while(r.line.length() < size)
+    {
+        seed = seed * 1103515245 + 12345;
+        if((seed >> 16) % 5 == 0)
+            r.line += escapes[(seed >> 8) % 5];
+        else
+            r.line += static_cast<char>('a' + (seed >> 16) % 26);
+    }
+    r.line += '"';
+    dbg_mi::DecodeRecordHeader(r.line.data(), r.line.length(), r.header);
+    return r;
+}
+
+// ----------------------------------------------------------------------------
+size_t ParseEscapedValue(Records const &records)
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = 0;
+    dbg_mi::ResultParser parser;
+    for(Records::const_iterator it = records.begin(); it != records.end(); ++it)
+    {
+        std::string line(it->line);
+        parser.Parse(line, it->header);
+        wxString value;
+        dbg_mi::Lookup(parser.GetResultValue(), dbg_mi::Atom_value, value);
+        bytes += it->line.length();
+    }
+    return bytes;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+int main(int argc, char **argv)
+// ----------------------------------------------------------------------------
+{
+    wxInitializer initializer;
+    if(not initializer)
+    {
+        std::fprintf(stderr, "wxWidgets initialization failed\n");
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    for(int ii = 1; ii < argc; ++ii)
+    {
+        if(std::strcmp(argv[ii], "-t") == 0 && ii + 1 < argc)
+            g_min_seconds = std::atof(argv[++ii]);
+        else
+            files.push_back(argv[ii]);
+    }
+    if(files.empty())
+    {
+        wxArrayString found;
+        wxDir::GetAllFiles(_T("corpus"), &found, _T("*.txt"), wxDIR_FILES);
+        found.Sort();
+        for(size_t ii = 0; ii < found.GetCount(); ++ii)
+            files.push_back(std::string(found[ii].utf8_str()));
+    }
+
+    Records records;
+    size_t corpus_bytes = 0;
+    for(size_t ii = 0; ii < files.size(); ++ii)
+    {
+        if(not LoadCorpus(files[ii].c_str(), records))
+            return 1;
+    }
+    for(Records::const_iterator it = records.begin(); it != records.end(); ++it)
+        corpus_bytes += it->line.length();
+    if(records.empty())
+    {
+        std::fprintf(stderr, "no MI records in the corpus\n");
+        return 1;
+    }
+    std::printf("corpus: %lu files, %lu records, %.2f MB\n\n", (unsigned long)files.size(),
+                (unsigned long)records.size(), corpus_bytes / (1024.0 * 1024.0));
+
+    Report("parse (lazy)", Run(records, [](Records const &r) { return ParseRecords(r, true); }));
+    Report("parse (eager)", Run(records, [](Records const &r) { return ParseRecords(r, false); }));
+    Report("parse + decode all", Run(records, ParseAndDecode));
+    Report("visit", Run(records, VisitRecords));
+    Report("typed records", Run(records, DecodeTypedRecords));
+
+    std::printf("\n");
+    static size_t const escaped_sizes[] = { 64 * 1024, 1024 * 1024, 4 * 1024 * 1024, 16 * 1024 * 1024 };
+    for(size_t ii = 0; ii < sizeof(escaped_sizes) / sizeof(escaped_sizes[0]); ++ii)
+    {
+        Records escaped(1, MakeEscapedRecord(escaped_sizes[ii]));
+        char name[64];
+        std::snprintf(name, sizeof(name), "escaped value %lu KB", (unsigned long)(escaped_sizes[ii] / 1024));
+        Report(name, Run(escaped, ParseEscapedValue));
+    }
+    return 0;
+}
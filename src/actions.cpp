@@ -1,5 +1,7 @@
 #include "actions.h"
 
+#include <algorithm>
+
 #include <cbdebugger_interfaces.h>
 #include <cbplugin.h>
 #include <cbeditor.h>
@@ -8,6 +10,9 @@
 #include <infowindow.h>
 
 #include "cmd_result_parser.h"
+#include "cmd_result_schema.h"
+#include "cmd_result_visitor.h"
+#include "diagnostics.h"
 #include "frame.h"
 #include "updated_variable.h"
 #include "helpers.h"
@@ -15,6 +20,12 @@
 namespace dbg_mi
 {
 
+// the watches are logged with their cbWatch debug string
+static wxString MakeDebugString(Watch::Pointer const &watch)
+{
+    return watch->GetDebugString();
+}
+
 // ----------------------------------------------------------------------------
 void BreakpointAddAction::OnStart()
 // ----------------------------------------------------------------------------
@@ -54,14 +65,14 @@ void BreakpointAddAction::OnStart()
     //        cmd.Replace(":15", ":99");
 
     m_initial_cmd = Execute(cmd);
-    m_logger.Debug(_T("BreakpointAddAction::m_initial_cmd = ") + m_initial_cmd.ToString());
+    Diagnostic(m_logger, Logger::Category::Breakpoints) << _T("BreakpointAddAction::m_initial_cmd = ") << m_initial_cmd;
 }
 
 // ----------------------------------------------------------------------------
 void BreakpointAddAction::OnCommandOutput(CommandID const &id, ResultParser const &result)
 // ----------------------------------------------------------------------------
 {
-    m_logger.Debug(_T("BreakpointAddAction::OnCommandResult: ") + id.ToString());
+    Diagnostic(m_logger, Logger::Category::Breakpoints) << _T("BreakpointAddAction::OnCommandResult: ") << id;
 
     if(m_initial_cmd == id)
     {
@@ -69,16 +80,19 @@ void BreakpointAddAction::OnCommandOutput(CommandID const &id, ResultParser cons
         const ResultValue &value = result.GetResultValue();
         if (result.GetResultClass() == ResultParser::ClassDone)
         {
-            //const ResultValue *number = value.GetTupleValue(_T("bkpt.number"));
+            static KeyPath const bkpt_number("bkpt.number");
+            static KeyPath const wpt_number("wpt.number");
+            static KeyPath const hw_rwpt_number("hw-rwpt.number");
+
             const ResultValue* number = 0;
             if (m_breakpoint->GetType() == _T("Code"))
-                number = value.GetTupleValue(_T("bkpt.number"));
+                number = value.GetTupleValue(bkpt_number);
             if (m_breakpoint->GetType() == _T("Data"))
             {
                 if (m_breakpoint->GetBreakOnDataWrite())
-                    number = value.GetTupleValue(_T("wpt.number"));
+                    number = value.GetTupleValue(wpt_number);
                 if (m_breakpoint->GetBreakOnDataRead())
-                    number= value.GetTupleValue(_T("hw-rwpt.number"));
+                    number= value.GetTupleValue(hw_rwpt_number);
             }
 
             if(number)
@@ -87,7 +101,8 @@ void BreakpointAddAction::OnCommandOutput(CommandID const &id, ResultParser cons
                 long n;
                 if(number_value.ToLong(&n, 10))
                 {
-                    m_logger.Debug(wxString::Format(_T("BreakpointAddAction::breakpoint index is %ld"), n));
+                    Diagnostic(m_logger, Logger::Category::Breakpoints)
+                        << _T("BreakpointAddAction::breakpoint index is ") << n;
                     m_breakpoint->SetIndex(n);
 
                     if(not m_breakpoint->IsEnabled())
@@ -97,18 +112,20 @@ void BreakpointAddAction::OnCommandOutput(CommandID const &id, ResultParser cons
                     }
                 }
                 else
-                    m_logger.Debug(_T("BreakpointAddAction::error getting the index :( "));
+                    Diagnostic(m_logger, Logger::Category::Breakpoints)
+                        << _T("BreakpointAddAction::error getting the index :( ");
             }
             else
             {
-                m_logger.Debug(_T("BreakpointAddAction::error getting number value:( "));
-                m_logger.Debug(value.MakeDebugString());
+                Diagnostic(m_logger, Logger::Category::Breakpoints)
+                    << _T("BreakpointAddAction::error getting number value:( ");
+                Diagnostic(m_logger, Logger::Category::Breakpoints, Logger::Verbosity::Trace) << value;
             }
         }
         else if (result.GetResultClass() == ResultParser::ClassError)
         {
             wxString message;
-            if (Lookup(value, _T("msg"), message))
+            if (Lookup(value, Atom_msg, message))
             {
                 // remove rejected breakpoint
                 wxString lineInfo(wxString::Format(_T(" %s:%d"), m_breakpoint->GetLocation().c_str(), m_breakpoint->GetLine()));
@@ -121,13 +138,13 @@ void BreakpointAddAction::OnCommandOutput(CommandID const &id, ResultParser cons
 
         if (finish)
         {
-            m_logger.Debug(_T("BreakpointAddAction::Finishing1"));
+            Diagnostic(m_logger, Logger::Category::Breakpoints) << _T("BreakpointAddAction::Finishing1");
             Finish();
         }
     }
     else if(m_disable_cmd == id)
     {
-        m_logger.Debug(_T("BreakpointAddAction::Finishing2"));
+        Diagnostic(m_logger, Logger::Category::Breakpoints) << _T("BreakpointAddAction::Finishing2");
         Finish();
     }
     // Show changes in breakpoint window
@@ -178,57 +195,37 @@ void GenerateBacktrace::OnCommandOutput(CommandID const &id, ResultParser const
 {
     if(id == m_backtrace_id)
     {
-        ResultValue const *stack = result.GetResultValue().GetTupleValue(_T("stack"));
-        if(not stack)
-            m_logger.Debug(_T("GenerateBacktrace::OnCommandOutput: no stack tuple in the output"));
+        m_backtrace.clear();
+
+        // the frames are decoded straight from the record, the stack is never built as a tree
+        RecordListCallback<Frame, GenerateBacktrace> stack(Atom_stack, Atom_frame, Frame::GetSchema(),
+                                                           *this, &GenerateBacktrace::ParseStackFrame);
+        bool parsed = result.Visit(stack);
+        if(not stack.Found())
+            Diagnostic(m_logger, Logger::Category::Backtrace)
+                << _T("GenerateBacktrace::OnCommandOutput: no stack tuple in the output");
         else
         {
-            int size = stack->GetTupleSize();
-            m_logger.Debug(wxString::Format(_T("GenerateBacktrace::OnCommandOutput: tuple size %d %s"),
-                                            size, stack->MakeDebugString().c_str()));
-
-            m_backtrace.clear();
-
-            for(int ii = 0; ii < size; ++ii)
-            {
-                ResultValue const *frame_value = stack->GetTupleValueByIndex(ii);
-                assert(frame_value);
-                Frame frame;
-                if(frame.ParseFrame(*frame_value))
-                {
-                    cbStackFrame s;
-                    if(frame.HasValidSource())
-                        s.SetFile(frame.GetFilename(), wxString::Format(_T("%d"), frame.GetLine()));
-                    else
-                        s.SetFile(frame.GetFrom(), wxEmptyString);
-                    s.SetSymbol(frame.GetFunction());
-                    s.SetNumber(ii);
-                    s.SetAddress(frame.GetAddress());
-                    s.MakeValid(frame.HasValidSource());
-                    if(s.IsValid() && m_first_valid == -1)
-                        m_first_valid = ii;
-
-                    m_backtrace.push_back(cbStackFrame::Pointer(new cbStackFrame(s)));
-                }
-                else
-                    m_logger.Debug(_T("can't parse frame: ") + frame_value->MakeDebugString());
-            }
+            Diagnostic(m_logger, Logger::Category::Backtrace)
+                << _T("GenerateBacktrace::OnCommandOutput: tuple size ") << stack.GetCount()
+                << (parsed ? _T("") : _T(" (malformed)"));
         }
         m_parsed_backtrace = true;
     }
     else if(id == m_args_id)
     {
-        m_logger.Debug(_T("GenerateBacktrace::OnCommandOutput arguments"));
+        Diagnostic(m_logger, Logger::Category::Backtrace) << _T("GenerateBacktrace::OnCommandOutput arguments");
         dbg_mi::FrameArguments arguments;
 
         if(not arguments.Attach(result.GetResultValue()))
         {
-            m_logger.Debug(_T("GenerateBacktrace::OnCommandOutput: can't attach to output of command: ")
-                           + id.ToString());
+            Diagnostic(m_logger, Logger::Category::Backtrace)
+                << _T("GenerateBacktrace::OnCommandOutput: can't attach to output of command: ") << id;
         }
         else if(arguments.GetCount() != static_cast<int>(m_backtrace.size()))
         {
-            m_logger.Debug(_T("GenerateBacktrace::OnCommandOutput: stack arg count differ from the number of frames"));
+            Diagnostic(m_logger, Logger::Category::Backtrace)
+                << _T("GenerateBacktrace::OnCommandOutput: stack arg count differ from the number of frames");
         }
         else
         {
@@ -240,9 +237,8 @@ void GenerateBacktrace::OnCommandOutput(CommandID const &id, ResultParser const
                     m_backtrace[ii]->SetSymbol(m_backtrace[ii]->GetSymbol() + _T("(") + args + _T(")"));
                 else
                 {
-                    m_logger.Debug(wxString::Format(_T("GenerateBacktrace::OnCommandOutput: ")
-                                                    _T("can't get args for frame %d"),
-                                                    ii));
+                    Diagnostic(m_logger, Logger::Category::Backtrace)
+                        << _T("GenerateBacktrace::OnCommandOutput: can't get args for frame ") << ii;
                 }
             }
         }
@@ -257,11 +253,12 @@ void GenerateBacktrace::OnCommandOutput(CommandID const &id, ResultParser const
         if (result.GetResultClass() != ResultParser::ClassDone)
         {
             m_old_active_frame = 0;
-            m_logger.Debug(_T("Wrong result class, using default value!"));
+            Diagnostic(m_logger, Logger::Category::Backtrace) << _T("Wrong result class, using default value!");
         }
         else
         {
-            if (not Lookup(result.GetResultValue(), _T("frame.level"), m_old_active_frame))
+            static KeyPath const frame_level("frame.level");
+            if (not Lookup(result.GetResultValue(), frame_level, m_old_active_frame))
                 m_old_active_frame = 0;
         }
     }
@@ -286,6 +283,31 @@ void GenerateBacktrace::OnCommandOutput(CommandID const &id, ResultParser const
         Finish();
     }
 }
+// ----------------------------------------------------------------------------
+bool GenerateBacktrace::ParseStackFrame(Frame &frame, DecodedFields const &fields, int index)
+// ----------------------------------------------------------------------------
+{
+    if(frame.Complete(fields))
+    {
+        cbStackFrame s;
+        if(frame.HasValidSource())
+            s.SetFile(frame.GetFilename(), wxString::Format(_T("%d"), frame.GetLine()));
+        else
+            s.SetFile(frame.GetFrom(), wxEmptyString);
+        s.SetSymbol(frame.GetFunction());
+        s.SetNumber(index);
+        s.SetAddress(frame.GetAddress());
+        s.MakeValid(frame.HasValidSource());
+        if(s.IsValid() && m_first_valid == -1)
+            m_first_valid = index;
+
+        m_backtrace.push_back(cbStackFrame::Pointer(new cbStackFrame(s)));
+    }
+    else
+        Diagnostic(m_logger, Logger::Category::Backtrace) << _T("can't parse frame: ") << index;
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 void GenerateBacktrace::OnStart()
 // ----------------------------------------------------------------------------
@@ -302,6 +324,7 @@ GenerateThreadsList::GenerateThreadsList(ThreadsContainer &threads, int current_
     m_logger(logger),
     m_current_thread_id(current_thread_id)
 {
+    SetPriority(PriorityBackground);
 }
 
 // ----------------------------------------------------------------------------
@@ -312,16 +335,17 @@ void GenerateThreadsList::OnCommandOutput(CommandID const & /*id*/, ResultParser
     m_threads.clear();
 
     int current_thread_id = 0;
-    if(not Lookup(result.GetResultValue(), _T("current-thread-id"), current_thread_id))
+    if(not Lookup(result.GetResultValue(), Atom_current_thread_id, current_thread_id))
     {
-        m_logger.Debug(_T("GenerateThreadsList::OnCommandOutput - no current thread id"));
+        Diagnostic(m_logger, Logger::Category::Threads)
+            << _T("GenerateThreadsList::OnCommandOutput - no current thread id");
         return;
     }
 
-    ResultValue const *threads = result.GetResultValue().GetTupleValue(_T("threads"));
+    ResultValue const *threads = result.GetResultValue().GetTupleValue(Atom_threads);
     if(not threads || (threads->GetType() != ResultValue::Tuple && threads->GetType() != ResultValue::Array))
     {
-        m_logger.Debug(_T("GenerateThreadsList::OnCommandOutput - no threads"));
+        Diagnostic(m_logger, Logger::Category::Threads) << _T("GenerateThreadsList::OnCommandOutput - no threads");
         return;
     }
     int count = threads->GetTupleSize();
@@ -330,22 +354,22 @@ void GenerateThreadsList::OnCommandOutput(CommandID const & /*id*/, ResultParser
         ResultValue const &thread_value = *threads->GetTupleValueByIndex(ii);
 
         int thread_id;
-        if(not Lookup(thread_value, _T("id"), thread_id))
+        if(not Lookup(thread_value, Atom_id, thread_id))
             continue;
 
         wxString info;
-        if(not Lookup(thread_value, _T("target-id"), info))
+        if(not Lookup(thread_value, Atom_target_id, info))
             info = wxEmptyString;
 
-        ResultValue const *frame_value = thread_value.GetTupleValue(_T("frame"));
+        ResultValue const *frame_value = thread_value.GetTupleValue(Atom_frame);
 
         if(frame_value)
         {
             wxString str;
 
-            if(Lookup(*frame_value, _T("addr"), str))
+            if(Lookup(*frame_value, Atom_addr, str))
                 info += _T(" ") + str;
-            if(Lookup(*frame_value, _T("func"), str))
+            if(Lookup(*frame_value, Atom_func, str))
             {
                 info += _T(" ") + str;
 
@@ -357,11 +381,11 @@ void GenerateThreadsList::OnCommandOutput(CommandID const & /*id*/, ResultParser
 
             int line;
 
-            if(Lookup(*frame_value, _T("file"), str) && Lookup(*frame_value, _T("line"), line))
+            if(Lookup(*frame_value, Atom_file, str) && Lookup(*frame_value, Atom_line, line))
             {
                 info += wxString::Format(_T(" in %s:%d"), str.c_str(), line);
             }
-            else if(Lookup(*frame_value, _T("from"), str))
+            else if(Lookup(*frame_value, Atom_from, str))
                 info += _T(" in ") + str;
         }
 
@@ -379,42 +403,17 @@ void GenerateThreadsList::OnStart()
 }
 
 // ----------------------------------------------------------------------------
-void ParseWatchInfo(ResultValue const &value, int &children_count, bool &dynamic, bool &has_more)
+void ParseWatchValueID(Watch &watch, VarObjectInfo const &info)
 // ----------------------------------------------------------------------------
 {
-    dynamic = has_more = false;
+    if(info.HasName())
+        watch.SetID(info.GetName());
 
-    int temp;
-    if (Lookup(value, _T("dynamic"), temp))
-        dynamic = (temp == 1);
-    if (Lookup(value, _T("has_more"), temp))
-        has_more = (temp == 1);
+    if(info.HasValue())
+        watch.SetValue(info.GetValue());
 
-    if(not Lookup(value, _T("numchild"), children_count))
-        children_count = -1;
-}
-
-// ----------------------------------------------------------------------------
-void ParseWatchValueID(Watch &watch, ResultValue const &value)
-// ----------------------------------------------------------------------------
-{
-    wxString s;
-    if(Lookup(value, _T("name"), s))
-        watch.SetID(s);
-
-    if(Lookup(value, _T("value"), s))
-        watch.SetValue(s);
-
-    if(Lookup(value, _T("type"), s))
-        watch.SetType(s);
-}
-
-// ----------------------------------------------------------------------------
-bool WatchHasType(ResultValue const &value)
-// ----------------------------------------------------------------------------
-{
-    wxString s;
-    return Lookup(value, _T("type"), s);
+    if(info.HasType())
+        watch.SetType(info.GetType());
 }
 
 // ----------------------------------------------------------------------------
@@ -425,29 +424,28 @@ void AppendNullChild(Watch::Pointer watch)
 }
 
 // ----------------------------------------------------------------------------
-Watch::Pointer AddChild(Watch::Pointer parent, ResultValue const &child_value, wxString const &symbol,
+Watch::Pointer AddChild(Watch::Pointer parent, VarObjectInfo const &child_info, wxString const &symbol,
                         WatchesContainer &watches)
 // ----------------------------------------------------------------------------
 {
-    wxString id;
-    if(not Lookup(child_value, _T("name"), id))
+    if(not child_info.HasName())
         return Watch::Pointer();
 
-    Watch::Pointer child = FindWatch(id, watches);
+    Watch::Pointer child = FindWatch(child_info.GetName(), watches);
     if(child)
     {
-        wxString s;
-        if(Lookup(child_value, _T("value"), s))
-            child->SetValue(s);
+        if(child_info.HasValue())
+            child->SetValue(child_info.GetValue());
 
-        if(Lookup(child_value, _T("type"), s))
-            child->SetType(s);
+        if(child_info.HasType())
+            child->SetType(child_info.GetType());
     }
     else
     {
         child = Watch::Pointer(new Watch(symbol, parent->ForTooltip(), parent->GetProject()));
-        ParseWatchValueID(*child, child_value);
+        ParseWatchValueID(*child, child_info);
         cbWatch::AddChild(parent, child);
+        watches.GetIndex().Add(child);
         child->ConvertValueToUserFormat();
     }
 
@@ -543,105 +541,111 @@ WatchBaseAction::~WatchBaseAction()
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-bool WatchBaseAction::ParseListCommand(CommandID const &id, ResultValue const &value)
+// Passes the child={...} entries of the 'children' list to ParseListChild as they are decoded.
+class WatchBaseAction::ChildrenVisitor : public RecordListVisitor<VarObjectInfo>
 {
-    bool error = false;
-    m_logger.Debug(_T("WatchBaseAction::ParseListCommand - steplistchildren for id: ")
-                   + id.ToString() + _T(" -> ") + value.MakeDebugString());
+public:
+    ChildrenVisitor(WatchBaseAction &action, Watch::Pointer parent_watch) :
+        RecordListVisitor<VarObjectInfo>(Atom_children, Atom_child, VarObjectInfo::GetSchema()),
+        m_action(action),
+        m_parent_watch(parent_watch),
+        m_error(false)
+    {
+    }
+
+    virtual bool OnRecord(VarObjectInfo &child_info, DecodedFields const &fields, int /*index*/)
+    {
+        child_info.Complete(fields);
+        if(not m_action.ParseListChild(m_parent_watch, child_info))
+            m_error = true;
+        return true;
+    }
+
+    bool HasError() const { return m_error; }
+private:
+    WatchBaseAction &m_action;
+    Watch::Pointer m_parent_watch;
+    bool m_error;
+};
+
+bool WatchBaseAction::ParseListCommand(CommandID const &id, ResultParser const &result)
+{
+    Diagnostic(m_logger, Logger::Category::Watches)
+        << _T("WatchBaseAction::ParseListCommand - steplistchildren for id: ") << id;
 
     ListCommandParentMap::iterator it = m_parent_map.find(id);
     if(it == m_parent_map.end() || !it->second)
     {
-        m_logger.Debug(_T("WatchBaseAction::ParseListCommand - no parent for id: ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches)
+            << _T("WatchBaseAction::ParseListCommand - no parent for id: ") << id;
         return false;
     }
 
-
-    ResultValue const *children = value.GetTupleValue(_T("children"));
-    if(children)
+    Watch::Pointer parent_watch = it->second;
+    // The children are handled one at a time, so a huge container doesn't need the whole tree.
+    ChildrenVisitor children(*this, parent_watch);
+    result.Visit(children);
+    if(children.Found())
     {
-        int count = children->GetTupleSize();
+        Diagnostic(m_logger, Logger::Category::Watches)
+            << _T("WatchBaseAction::ParseListCommand - children ") << children.GetCount();
+        RemoveMarkedWatchChildren(parent_watch, m_watches);
+    }
+    return !children.HasError();
+}
 
-        m_logger.Debug(wxString::Format(_T("WatchBaseAction::ParseListCommand - children %d"), count));
-        Watch::Pointer parent_watch = it->second;
+bool WatchBaseAction::ParseListChild(Watch::Pointer parent_watch, VarObjectInfo const &child_info)
+{
+    bool error = false;
+    wxString symbol = child_info.HasExpression() ? child_info.GetExpression() : wxString(_T("--unknown--"));
 
-        for(int ii = 0; ii < count; ++ii)
-        {
-            ResultValue const *child_value;
-            child_value = children->GetTupleValueByIndex(ii);
+    Watch::Pointer child;
+    bool dynamic = child_info.IsDynamic();
+    bool has_more = child_info.HasMore();
+    int children_count = child_info.GetChildrenCount();
 
-            if(child_value->GetName() == _T("child"))
+    if(dynamic && has_more)
+    {
+        child = Watch::Pointer(new Watch(symbol, parent_watch->ForTooltip(), parent_watch->GetProject()));
+        ParseWatchValueID(*child, child_info);
+        ExecuteListCommand(child, parent_watch);
+    }
+    else
+    {
+        switch(children_count)
+        {
+        case -1:
+            error = true;
+            break;
+        case 0:
+            if(not parent_watch->HasBeenExpanded())
             {
-                wxString symbol;
-                if(not Lookup(*child_value, _T("exp"), symbol))
-                    symbol = _T("--unknown--");
-
-                Watch::Pointer child;
-                bool dynamic, has_more;
-
-                int children_count;
-                ParseWatchInfo(*child_value, children_count, dynamic, has_more);
-
-                if(dynamic && has_more)
-                {
-                    child = Watch::Pointer(new Watch(symbol, parent_watch->ForTooltip(), parent_watch->GetProject()));
-                    ParseWatchValueID(*child, *child_value);
-                    ExecuteListCommand(child, parent_watch);
-                }
-                else
-                {
-                    switch(children_count)
-                    {
-                    case -1:
-                        error = true;
-                        break;
-                    case 0:
-                        if(not parent_watch->HasBeenExpanded())
-                        {
-                            parent_watch->SetHasBeenExpanded(true);
-                            parent_watch->RemoveChildren();
-                        }
-                        child = AddChild(parent_watch, *child_value, symbol, m_watches);
-                        if (dynamic)
-                        {
-                            wxString id;
-                            if(Lookup(*child_value, _T("name"), id))
-                                ExecuteListCommand(id, child);
-                        }
-                        child = Watch::Pointer();
-                        break;
-                    default:
-                        if(WatchHasType(*child_value))
-                        {
-                            if(not parent_watch->HasBeenExpanded())
-                            {
-                                parent_watch->SetHasBeenExpanded(true);
-                                parent_watch->RemoveChildren();
-                            }
-                            child = AddChild(parent_watch, *child_value, symbol, m_watches);
-                            AppendNullChild(child);
-
-                            m_logger.Debug(_T("WatchBaseAction::ParseListCommand - adding child ")
-                                           + child->GetDebugString()
-                                           + _T(" to ") + parent_watch->GetDebugString());
-                            child = Watch::Pointer();
-                        }
-                        else
-                        {
-                            wxString id;
-                            if(Lookup(*child_value, _T("name"), id))
-                                ExecuteListCommand(id, parent_watch);
-                        }
-                    }
-                }
+                parent_watch->SetHasBeenExpanded(true);
+                RemoveWatchChildren(parent_watch, m_watches);
             }
-            else
+            child = AddChild(parent_watch, child_info, symbol, m_watches);
+            if (dynamic && child_info.HasName())
+                ExecuteListCommand(child_info.GetName(), child);
+            child = Watch::Pointer();
+            break;
+        default:
+            if(child_info.HasType())
             {
-                m_logger.Debug(_T("WatchBaseAction::ParseListCommand - can't find child in ")
-                               + children->GetTupleValueByIndex(ii)->MakeDebugString());
+                if(not parent_watch->HasBeenExpanded())
+                {
+                    parent_watch->SetHasBeenExpanded(true);
+                    RemoveWatchChildren(parent_watch, m_watches);
+                }
+                child = AddChild(parent_watch, child_info, symbol, m_watches);
+                AppendNullChild(child);
+
+                Diagnostic(m_logger, Logger::Category::Watches)
+                    << _T("WatchBaseAction::ParseListCommand - adding child ") << child << _T(" to ") << parent_watch;
+                child = Watch::Pointer();
             }
+            else if(child_info.HasName())
+                ExecuteListCommand(child_info.GetName(), parent_watch);
         }
-        parent_watch->RemoveMarkedChildren();
     }
     return !error;
 }
@@ -670,7 +674,8 @@ void WatchBaseAction::ExecuteListCommand(wxString const &watch_id, Watch::Pointe
 {
     if (not parent)
     {
-        m_logger.Debug(_T("Parent for '") + watch_id + _T("' is NULL; skipping this watch"));
+        Diagnostic(m_logger, Logger::Category::Watches)
+            << _T("Parent for '") << watch_id << _T("' is NULL; skipping this watch");
         return;
     }
     CommandID id;
@@ -699,7 +704,8 @@ void WatchCreateAction::OnCommandOutput(CommandID const &id, ResultParser const
 // ----------------------------------------------------------------------------
 {
     --m_sub_commands_left;
-    m_logger.Debug(_T("WatchCreateAction::OnCommandOutput - processing command ") + id.ToString());
+    Diagnostic(m_logger, Logger::Category::Watches)
+        << _T("WatchCreateAction::OnCommandOutput - processing command ") << id;
     bool error = false;
 
     if(result.GetResultClass() == ResultParser::ClassDone)
@@ -722,18 +728,18 @@ void WatchCreateAction::OnCommandOutput(CommandID const &id, ResultParser const
 
         case StepCreate:
             {
-                bool dynamic, has_more;
-                int children;
-                ParseWatchInfo(value, children, dynamic, has_more);
-                ParseWatchValueID(*m_watch, value);
+                VarObjectInfo info;
+                info.Parse(value);
+                ParseWatchValueID(*m_watch, info);
+                m_watches.GetIndex().Add(m_watch);
 
-                if(dynamic && has_more)
+                if(info.IsDynamic() && info.HasMore())
                 {
                     m_step = StepSetRange;
                     Execute(_T("-var-set-update-range \"") + m_watch->GetID() + _T("\" 0 100"));
                     AppendNullChild(m_watch);
                 }
-                else if(children > 0)
+                else if(info.GetChildrenCount() > 0)
                 {
                     m_step = StepListChildren;
                     AppendNullChild(m_watch);
@@ -747,7 +753,7 @@ void WatchCreateAction::OnCommandOutput(CommandID const &id, ResultParser const
             break;
 
         case StepListChildren:
-            error = !ParseListCommand(id, value);
+            error = !ParseListCommand(id, result);
             break;
 
         case StepSetRange:
@@ -771,7 +777,7 @@ void WatchCreateAction::OnCommandOutput(CommandID const &id, ResultParser const
         error = true;
         const ResultValue &value = result.GetResultValue();
         wxString message;
-        if (Lookup(value, _T("msg"), message))
+        if (Lookup(value, Atom_msg, message))
         {
             // Handle debugger message here if needed
         }
@@ -779,20 +785,21 @@ void WatchCreateAction::OnCommandOutput(CommandID const &id, ResultParser const
 
     if(error)
     {
-        m_logger.Debug(_T("WatchCreateAction::OnCommandOutput - error in command: ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches)
+            << _T("WatchCreateAction::OnCommandOutput - error in command: ") << id;
         UpdateWatches(m_logger);
         Finish();
     }
     else if(m_sub_commands_left == 0)
     {
-        m_logger.Debug(_T("WatchCreateAction::Output - finishing at ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchCreateAction::Output - finishing at ") << id;
         UpdateWatches(m_logger);
         Finish();
     }
 
     if (result.GetParseError())
     {
-        m_logger.Debug(_T("WatchCreateAction::Output - parse error ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchCreateAction::Output - parse error ") << id;
         m_watch->SetValue(_T("Malformed debugger response"));
         UpdateWatches(m_logger);
         Finish();
@@ -848,27 +855,48 @@ WatchesUpdateAction::WatchesUpdateAction(WatchesContainer &watches, Logger &logg
     watch = singleWatch;
 }
 
+// ----------------------------------------------------------------------------
+WatchesUpdateAction::WatchesUpdateAction(WatchesContainer &watches, Logger &logger, wxArrayString const &names,
+                                         int in_flight_limit)
+// ----------------------------------------------------------------------------
+    : WatchBaseAction(watches, logger),
+    m_names(names)
+{
+    // one -var-update per watch after each step, plus the -var-list-children of the
+    // changed ones; in a limited window half of it is left for the user's requests
+    if (in_flight_limit > 0)
+        SetMaxInFlight(std::max(1, in_flight_limit / 2));
+}
+
 // ----------------------------------------------------------------------------
 void WatchesUpdateAction::OnStart()
 // ----------------------------------------------------------------------------
 {
+    // the changes of the previous update aren't shown anymore
+    for(WatchesContainer::iterator it = m_watches.begin();  it != m_watches.end(); ++it)
+        (*it)->MarkAsChangedRecursive(false);
+
     // Check for single variable update
     if (watch)
     {
-        wxString id = watch->GetID();
-        if (not id.empty())
-        {
-            wxString cmd = wxString::Format(_T("-var-update 1 %s"),id.wx_str());
-            m_update_command = Execute(cmd);
-        }
+        m_names.Clear();
+        if (not watch->GetID().empty())
+            m_names.Add(watch->GetID());
         else
+        {
             Finish();
+            return;
+        }
     }
-    //else ;
-    // check for single variable update
 
-    m_update_command = Execute(_T("-var-update 1 *"));
-    m_sub_commands_left = 1;
+    if (m_names.empty())
+        m_update_commands.push_back(Execute(_T("-var-update 1 *")));
+    else
+    {
+        for (size_t ii = 0; ii < m_names.GetCount(); ++ii)
+            m_update_commands.push_back(Execute(_T("-var-update 1 ") + m_names[ii]));
+    }
+    m_sub_commands_left = m_update_commands.size();
 }
 
 // ----------------------------------------------------------------------------
@@ -876,98 +904,101 @@ bool WatchesUpdateAction::ParseUpdate(ResultParser const &result)
 // ----------------------------------------------------------------------------
 {
     if(result.GetResultClass() == ResultParser::ClassError)
-    {
-        Finish();
         return false;
+    // the entries are decoded straight from the record, one at a time
+    RecordListCallback<UpdatedVariable, WatchesUpdateAction> changelist(Atom_changelist, Atom_Unknown,
+                                                                        UpdatedVariable::GetSchema(), *this,
+                                                                        &WatchesUpdateAction::ParseUpdatedVariable);
+    result.Visit(changelist);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool WatchesUpdateAction::ParseUpdatedVariable(UpdatedVariable &updated_var, DecodedFields const &fields,
+                                               int /*index*/)
+// ----------------------------------------------------------------------------
+{
+    bool parsed = updated_var.Complete(fields);
+    if(not fields.Has(Atom_name))
+    {
+        Diagnostic(m_logger, Logger::Category::Watches, Logger::Verbosity::Trace)
+            << _T("WatchesUpdateAction::Output - no name in ") << updated_var;
+        return true;
+    }
+
+    wxString const &expression = updated_var.GetName();
+    Watch::Pointer watch = FindWatch(expression, m_watches);
+    if(not watch)
+    {
+        Diagnostic(m_logger, Logger::Category::Watches)
+            << _T("WatchesUpdateAction::Output - can't find watch ") << expression;
+        return true;
     }
-    ResultValue const *list = result.GetResultValue().GetTupleValue(_T("changelist"));
-    if(list)
+
+    if(parsed)
     {
-        int count = list->GetTupleSize();
-        for(int ii = 0; ii < count; ++ii)
+        switch(updated_var.GetInScope())
         {
-            ResultValue const *value = list->GetTupleValueByIndex(ii);
-
-            wxString expression;
-            if(not Lookup(*value, _T("name"), expression))
+        case UpdatedVariable::InScope_No:
+            watch->Expand(false);
+            RemoveWatchChildren(watch, m_watches);
+            watch->SetValue(_T("-- not in scope --"));
+            break;
+        case UpdatedVariable::InScope_Invalid:
+            watch->Expand(false);
+            RemoveWatchChildren(watch, m_watches);
+            watch->SetValue(_T("-- invalid -- "));
+            break;
+        case UpdatedVariable::InScope_Yes:
+            if(updated_var.IsDynamic())
             {
-                m_logger.Debug(_T("WatchesUpdateAction::Output - no name in ") + value->MakeDebugString());
-                continue;
-            }
+                if(updated_var.HasNewNumberOfChildren())
+                {
+                    RemoveWatchChildren(watch, m_watches);
 
-            Watch::Pointer watch = FindWatch(expression, m_watches);
-            if(not watch)
-            {
-                m_logger.Debug(_T("WatchesUpdateAction::Output - can't find watch ") + expression);
-                continue;
+                    if(updated_var.GetNewNumberOfChildren() > 0)
+                        ExecuteListCommand(watch);
+                }
+                else if(updated_var.HasMore())
+                {
+                    watch->MarkChildsAsRemoved(); // watch->RemoveChildren();
+                    ExecuteListCommand(watch);
+                }
+                else if(updated_var.HasValue())
+                {
+                    watch->SetValue(updated_var.GetValue());
+                    watch->MarkAsChanged(true);
+                }
+                else
+                {
+                    Diagnostic(m_logger, Logger::Category::Watches)
+                        << _T("WatchesUpdateAction::Output - unhandled dynamic variable");
+                    Diagnostic(m_logger, Logger::Category::Watches, Logger::Verbosity::Trace)
+                        << _T("WatchesUpdateAction::Output - ") << updated_var;
+                }
             }
-
-            UpdatedVariable updated_var;
-            if(updated_var.Parse(*value))
+            else
             {
-                switch(updated_var.GetInScope())
+                if(updated_var.HasNewNumberOfChildren())
                 {
-                case UpdatedVariable::InScope_No:
-                    watch->Expand(false);
-                    watch->RemoveChildren();
-                    watch->SetValue(_T("-- not in scope --"));
-                    break;
-                case UpdatedVariable::InScope_Invalid:
-                    watch->Expand(false);
-                    watch->RemoveChildren();
-                    watch->SetValue(_T("-- invalid -- "));
-                    break;
-                case UpdatedVariable::InScope_Yes:
-                    if(updated_var.IsDynamic())
-                    {
-                        if(updated_var.HasNewNumberOfChildren())
-                        {
-                            watch->RemoveChildren();
-
-                            if(updated_var.GetNewNumberOfChildren() > 0)
-                                ExecuteListCommand(watch);
-                        }
-                        else if(updated_var.HasMore())
-                        {
-                            watch->MarkChildsAsRemoved(); // watch->RemoveChildren();
-                            ExecuteListCommand(watch);
-                        }
-                        else if(updated_var.HasValue())
-                        {
-                            watch->SetValue(updated_var.GetValue());
-                            watch->MarkAsChanged(true);
-                        }
-                        else
-                        {
-                            m_logger.Debug(_T("WatchesUpdateAction::Output - unhandled dynamic variable"));
-                            m_logger.Debug(_T("WatchesUpdateAction::Output - ") + updated_var.MakeDebugString());
-                        }
-                    }
-                    else
-                    {
-                        if(updated_var.HasNewNumberOfChildren())
-                        {
-                            watch->RemoveChildren();
-
-                            if(updated_var.GetNewNumberOfChildren() > 0)
-                                ExecuteListCommand(watch);
-                        }
-                        if(updated_var.HasValue())
-                        {
-                            watch->SetValue(updated_var.GetValue());
-                            watch->MarkAsChanged(true);
-                            m_logger.Debug(_T("WatchesUpdateAction::Output - ")
-                                           + expression + _T(" = ") + updated_var.GetValue());
-                        }
-                        else
-                        {
-                            watch->SetValue(wxEmptyString);
-                        }
-                    }
-                    break;
+                    RemoveWatchChildren(watch, m_watches);
+
+                    if(updated_var.GetNewNumberOfChildren() > 0)
+                        ExecuteListCommand(watch);
+                }
+                if(updated_var.HasValue())
+                {
+                    watch->SetValue(updated_var.GetValue());
+                    watch->MarkAsChanged(true);
+                    Diagnostic(m_logger, Logger::Category::Watches)
+                        << _T("WatchesUpdateAction::Output - ") << expression << _T(" = ") << updated_var.GetValue();
+                }
+                else
+                {
+                    watch->SetValue(wxEmptyString);
                 }
             }
-
+            break;
         }
     }
     return true;
@@ -979,12 +1010,10 @@ void WatchesUpdateAction::OnCommandOutput(CommandID const &id, ResultParser cons
 {
     --m_sub_commands_left;
 
-    if(id == m_update_command)
+    if(std::find(m_update_commands.begin(), m_update_commands.end(), id) != m_update_commands.end())
     {
-        for(WatchesContainer::iterator it = m_watches.begin();  it != m_watches.end(); ++it)
-            (*it)->MarkAsChangedRecursive(false);
-
-        if(not ParseUpdate(result))
+        // a var object of several which is gone doesn't stop the others
+        if(not ParseUpdate(result) && m_update_commands.size() == 1)
         {
             Finish();
             return;
@@ -992,10 +1021,10 @@ void WatchesUpdateAction::OnCommandOutput(CommandID const &id, ResultParser cons
     }
     else
     {
-        ResultValue const &value = result.GetResultValue();
-        if(not ParseListCommand(id, value))
+        if(not ParseListCommand(id, result))
         {
-            m_logger.Debug(_T("WatchUpdateAction::Output - ParseListCommand failed ") + id.ToString());
+            Diagnostic(m_logger, Logger::Category::Watches)
+                << _T("WatchUpdateAction::Output - ParseListCommand failed ") << id;
             Finish();
             return;
         }
@@ -1003,7 +1032,7 @@ void WatchesUpdateAction::OnCommandOutput(CommandID const &id, ResultParser cons
 
     if(m_sub_commands_left == 0)
     {
-        m_logger.Debug(_T("WatchUpdateAction::Output - finishing at") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchUpdateAction::Output - finishing at") << id;
         UpdateWatches(m_logger);
         Finish();
     }
@@ -1033,7 +1062,8 @@ void WatchEvaluateExpression::OnStart()
 void WatchEvaluateExpression::OnCommandOutput(CommandID const &id, ResultParser const &result)
 // ----------------------------------------------------------------------------
 {
-    m_logger.Debug(_T("WatchEvaluateExpression::OnCommandOutput - processing command ") + id.ToString());
+    Diagnostic(m_logger, Logger::Category::Watches)
+        << _T("WatchEvaluateExpression::OnCommandOutput - processing command ") << id;
     bool error = false;
     if(result.GetResultClass() == ResultParser::ClassDone)
     {
@@ -1041,7 +1071,10 @@ void WatchEvaluateExpression::OnCommandOutput(CommandID const &id, ResultParser
         if (value.GetTupleSize())
         {
             m_watch->MarkAsChanged(true);
-            ParseWatchValueID(*m_watch, value);
+            VarObjectInfo info;
+            info.Parse(value);
+            ParseWatchValueID(*m_watch, info);
+            m_watches.GetIndex().Add(m_watch);
 
             Finish();
         }
@@ -1059,13 +1092,14 @@ void WatchEvaluateExpression::OnCommandOutput(CommandID const &id, ResultParser
 
     if(error)
     {
-        m_logger.Debug(_T("WatchEvaluateExpression::OnCommandOutput - error in command: ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches)
+            << _T("WatchEvaluateExpression::OnCommandOutput - error in command: ") << id;
         UpdateWatches(m_logger);
         Finish();
     }
     else if(m_sub_commands_left == 0)
     {
-        m_logger.Debug(_T("WatchEvaluateExpression::Output - finishing at") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchEvaluateExpression::Output - finishing at") << id;
         UpdateWatches(m_logger);
         Finish();
     }
@@ -1073,7 +1107,7 @@ void WatchEvaluateExpression::OnCommandOutput(CommandID const &id, ResultParser
     // parse error on malformed response
     if (result.GetParseError())
     {
-        m_logger.Debug(_T("WatchEvaluateExpression::Output - parse error ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchEvaluateExpression::Output - parse error ") << id;
         m_watch->SetValue(_T("Malformed debugger response"));
         UpdateWatches(m_logger);
         Finish();
@@ -1154,17 +1188,16 @@ void WatchExpandedAction::OnCommandOutput(CommandID const &id, ResultParser cons
         return;
 
     --m_sub_commands_left;
-    m_logger.Debug(_T("WatchExpandedAction::Output - ") + result.GetResultValue().MakeDebugString());
-    if(not ParseListCommand(id, result.GetResultValue()))
+    if(not ParseListCommand(id, result))
     {
-        m_logger.Debug(_T("WatchExpandedAction::Output - error in command ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchExpandedAction::Output - error in command ") << id;
         // Update the watches even if there is an error, so some partial information can be displayed.
         UpdateWatchesTooltipOrAll(m_expanded_watch, m_logger);
         Finish();
     }
     else if(m_sub_commands_left == 0)
     {
-        m_logger.Debug(_T("WatchExpandedAction::Output - done"));
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchExpandedAction::Output - done");
         UpdateWatchesTooltipOrAll(m_expanded_watch, m_logger);
         Finish();
     }
@@ -1172,7 +1205,7 @@ void WatchExpandedAction::OnCommandOutput(CommandID const &id, ResultParser cons
     // parse error on malformed response
     if (result.GetParseError())
     {
-        m_logger.Debug(_T("WatchExpandedAction::Output - parse error ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Watches) << _T("WatchExpandedAction::Output - parse error ") << id;
         m_watch->SetValue(_T("Malformed debugger response"));
         // Update the watches even if there is an error, so some partial information can be displayed.
         m_expanded_watch->RemoveChildren(); //remove "updating... message"
@@ -1198,7 +1231,7 @@ void WatchCollapseAction::OnCommandOutput(CommandID const &id, ResultParser cons
     if(result.GetResultClass() == ResultParser::ClassDone)
     {
         m_collapsed_watch->SetHasBeenExpanded(false);
-        m_collapsed_watch->RemoveChildren();
+        RemoveWatchChildren(m_collapsed_watch, m_watches);
         AppendNullChild(m_collapsed_watch);
         UpdateWatchesTooltipOrAll(m_collapsed_watch, m_logger);
     }
@@ -1215,6 +1248,7 @@ InfoRegisters::InfoRegisters(Logger &logger, wxString disassemblyFlavor) :
             m_parsed_reg_names(false),
             m_parsed_reg_values(false)
 {
+    SetPriority(PriorityBackground);
 }
 // ----------------------------------------------------------------------------
 InfoRegisters::~InfoRegisters()
@@ -1249,9 +1283,10 @@ void InfoRegisters::OnCommandOutput(CommandID const &id, ResultParser const &res
     {
         m_parsed_reg_values = true;
 
-        ResultValue const *regs = result.GetResultValue().GetTupleValue(_T("register-values"));
+        ResultValue const *regs = result.GetResultValue().GetTupleValue(Atom_register_values);
         if(not regs)
-            m_logger.Debug(_("InfoRegisters::OnCommandOutput: no register-values tuple in the output"));
+            Diagnostic(m_logger, Logger::Category::Registers)
+                << _("InfoRegisters::OnCommandOutput: no register-values tuple in the output");
         else
         {
             // or32 register string parser
@@ -1263,15 +1298,15 @@ void InfoRegisters::OnCommandOutput(CommandID const &id, ResultParser const &res
             {
                 //cbCPURegistersDlg *dialog = Manager::Get()->GetDebuggerManager()->GetCPURegistersDialog();
                 int isize = regs->GetTupleSize();
-                m_logger.Debug(wxString::Format(_T("InfoRegisters::OnCommandOutput: tuple size %d %s"),
-                                                isize, regs->MakeDebugString().c_str()));
+                Diagnostic(m_logger, Logger::Category::Registers, Logger::Verbosity::Trace)
+                    << _T("InfoRegisters::OnCommandOutput: tuple size ") << isize << _T(" ") << *regs;
 
                 for(int ii = 0; ii < isize; ++ii)
                 {
                     const ResultValue* pReg_value = regs->GetTupleValueByIndex(ii);
                     assert(pReg_value);
-                    const ResultValue* pRegNumber = pReg_value->GetTupleValue(_T("number"));
-                    const ResultValue* pRegValue = pReg_value->GetTupleValue(_T("value"));
+                    const ResultValue* pRegNumber = pReg_value->GetTupleValue(Atom_number);
+                    const ResultValue* pRegValue = pReg_value->GetTupleValue(Atom_value);
 
                     if(pRegValue->GetSimpleValue() != wxEmptyString) //keep in sync with regNames
                     {
@@ -1280,7 +1315,8 @@ void InfoRegisters::OnCommandOutput(CommandID const &id, ResultParser const &res
                         regValues.Add( pRegValue->GetSimpleValue());
                     }
                     else
-                        m_logger.Debug(_T("can't parse registers: ") + pReg_value->MakeDebugString());
+                        Diagnostic(m_logger, Logger::Category::Registers, Logger::Verbosity::Trace)
+                            << _T("can't parse registers: ") << *pReg_value;
                 }
 
             }//else
@@ -1298,9 +1334,10 @@ void InfoRegisters::OnCommandOutput(CommandID const &id, ResultParser const &res
     {
         m_parsed_reg_names = true;
 
-        ResultValue const *regs = result.GetResultValue().GetTupleValue(_T("register-names"));
+        ResultValue const *regs = result.GetResultValue().GetTupleValue(Atom_register_names);
         if(not regs)
-            m_logger.Debug(_T("InfoRegisters::OnCommandOutput: no register-names tuple in the output"));
+            Diagnostic(m_logger, Logger::Category::Registers)
+                << _T("InfoRegisters::OnCommandOutput: no register-names tuple in the output");
         else
         {
             // or32 register string parser
@@ -1311,8 +1348,8 @@ void InfoRegisters::OnCommandOutput(CommandID const &id, ResultParser const &res
             else    // use generic parser - this may work for other platforms or you may have to write your own
             {
                 int isize = regs->GetTupleSize();
-                m_logger.Debug(wxString::Format(_T("InfoRegisters::OnCommandOutput: tuple size %d %s"),
-                                                isize, regs->MakeDebugString().c_str()));
+                Diagnostic(m_logger, Logger::Category::Registers, Logger::Verbosity::Trace)
+                    << _T("InfoRegisters::OnCommandOutput: tuple size ") << isize << _T(" ") << *regs;
 
                 for(int ii = 0; ii < isize; ++ii)
                 {
@@ -1405,6 +1442,7 @@ GenerateDisassembly::GenerateDisassembly(Logger &logger, bool MixedMode, wxStrin
     :  m_logger(logger),
        m_mixedMode(MixedMode)
 {
+    SetPriority(PriorityBackground);
     m_Cmd << _T("-data-disassemble -s");
 
     if(hexAddrStr.IsEmpty())
@@ -1449,16 +1487,17 @@ void GenerateDisassembly::OnCommandOutput(CommandID const &id, ResultParser cons
         m_parsed_frame_info = true;
         //^done,frame={level="0",addr="0x0000000000401060",func="main",
         //file="/path/main.cpp",fullname="/path/main.cpp",line="80"}
-        ResultValue const* resultValue = result.GetResultValue().GetTupleValue(_T("frame"));
+        ResultValue const* resultValue = result.GetResultValue().GetTupleValue(Atom_frame);
         if(not resultValue)
         {
-            m_logger.Debug(_T("GenerateDisassembly::OnCommandOutput: no frame tuple in the output"));
+            Diagnostic(m_logger, Logger::Category::Disassembly)
+                << _T("GenerateDisassembly::OnCommandOutput: no frame tuple in the output");
             Finish();
             return;
         }
-        const ResultValue* pAddr = resultValue->GetTupleValue(_T("addr"));
+        const ResultValue* pAddr = resultValue->GetTupleValue(Atom_addr);
         assert(pAddr);
-        const ResultValue* pfunc = resultValue->GetTupleValue(_T("func"));
+        const ResultValue* pfunc = resultValue->GetTupleValue(Atom_func);
         assert(pfunc);
         unsigned long int addr;
         pAddr->GetSimpleValue().ToULong(&addr, 16);
@@ -1472,111 +1511,23 @@ void GenerateDisassembly::OnCommandOutput(CommandID const &id, ResultParser cons
     else if (id == m_disassemble_info_id)
     {
         m_parsed_disassemble_info = true;
-        ResultValue const* resultValue = result.GetResultValue().GetTupleValue(_T("asm_insns"));
-        if(not resultValue)
+        // the instructions are added to the dialog while the list is parsed
+        ResultListCallback<GenerateDisassembly> asm_insns(Atom_asm_insns, *this,
+                                                          m_mixedMode ? &GenerateDisassembly::ParseSourceAndAsmLine
+                                                                      : &GenerateDisassembly::ParseAsmInstruction);
+        bool parsed = result.Visit(asm_insns);
+        if(not asm_insns.Found())
         {
-            m_logger.Debug(_T("GenerateDisassembly::OnCommandOutput: no disassemble tuple in the output"));
+            Diagnostic(m_logger, Logger::Category::Disassembly)
+                << _T("GenerateDisassembly::OnCommandOutput: no disassemble tuple in the output");
             Finish();
             return;
         }
         else
         {
-            int knt = resultValue->GetTupleSize();
-            m_logger.Debug(wxString::Format(_T("GenerateAssembly::OnCommandOutput: tuple size %d %s"),
-                                            knt, resultValue->MakeDebugString().c_str()));
-
-
-            if ( m_mixedMode ) for ( int ii = 0; ii < knt; ++ii)
-            {
-                // (gdb)
-                //- -data-disassemble -f basics.c -l 32 -n 3 -- 1
-                // -data-disassemble -s $pc -e "$pc + 20" -- 0
-                // ^done,asm_insns=[
-                // src_and_asm_line={line="31",
-                // file="/kwikemart/marge/ezannoni/flathead-dev/devo/gdb/
-                //   testsuite/gdb.mi/basics.c",line_asm_insn=[
-                // {address="0x000107bc",func-name="main",offset="0",
-                // inst="save  %sp, -112, %sp"}]},
-                // src_and_asm_line={line="32",
-                // file="/kwikemart/marge/ezannoni/flathead-dev/devo/gdb/
-                //   testsuite/gdb.mi/basics.c",line_asm_insn=[
-                // {address="0x000107c0",func-name="main",offset="4",
-                // inst="mov  2, %o0"},
-                // {address="0x000107c4",func-name="main",offset="8",
-                // inst="sethi  %hi(0x11800), %o2"}]}]
-                // (gdb)
-
-                const ResultValue* pSrcAsmLine = resultValue->GetTupleValueByIndex(ii);
-                assert(pSrcAsmLine);
-                const ResultValue* pLineNo = pSrcAsmLine->GetTupleValue(_T("line"));
-
-                assert(pLineNo);
-                const ResultValue* pFile = pSrcAsmLine->GetTupleValue(_T("file"));
-                assert(pFile);
-
-                const ResultValue* pLine_asm_insn = pSrcAsmLine->GetTupleValue(_T("line_asm_insn"));
-                assert(pLine_asm_insn);
-
-                unsigned long int lineno ;
-                pLineNo->GetSimpleValue().ToULong(&lineno, 10) ;
-                // cb editors are 0 oriented, gdb is 1 oriented
-                //-if (lineno > 0) lineno -= 1;
-                //dialog->AddSourceLineByFile(lineno, pFile->GetSimpleValue());
-                AddSourceLineByFile(lineno, pFile->GetSimpleValue());
-
-                int laiKnt = pLine_asm_insn->GetTupleSize();
-                for ( int jj = 0; jj < laiKnt; ++jj)
-                {
-                    const ResultValue* pLineInsns = pLine_asm_insn->GetTupleValueByIndex(jj);
-                    const ResultValue* pAddr = pLineInsns->GetTupleValue(_T("address"));
-                    assert(pAddr);
-                    const ResultValue* pfunc = pLineInsns->GetTupleValue(_T("func-name"));
-                    assert(pfunc);
-                    const ResultValue* pOffset = pLineInsns->GetTupleValue(_T("offset"));
-                    assert(pOffset);
-                    const ResultValue* pInst = pLineInsns->GetTupleValue(_T("inst"));
-                    assert(pInst);
-                    unsigned long int addr;
-                    pAddr->GetSimpleValue().ToULong(&addr, 16);
-                    dialog->AddAssemblerLine(addr, pInst->GetSimpleValue());
-                }
-
-            }//for mixedMode
-
-            if (not m_mixedMode) for ( int ii = 0; ii < knt; ++ii)
-            {
-                // (gdb)
-                // -data-disassemble -s $pc -e "$pc + 20" -- 0
-                // ^done,
-                // asm_insns=[
-                // {address="0x000107c0",func-name="main",offset="4",
-                // inst="mov  2, %o0"},
-                // {address="0x000107c4",func-name="main",offset="8",
-                // inst="sethi  %hi(0x11800), %o2"},
-                // {address="0x000107c8",func-name="main",offset="12",
-                // inst="or  %o2, 0x140, %o1\t! 0x11940 <_lib_version+8>"},
-                // {address="0x000107cc",func-name="main",offset="16",
-                // inst="sethi  %hi(0x11800), %o2"},
-                // {address="0x000107d0",func-name="main",offset="20",
-                // inst="or  %o2, 0x168, %o4\t! 0x11968 <_lib_version+48>"}]
-                // (gdb)
-
-                const ResultValue* pAsmInsns = resultValue->GetTupleValueByIndex(ii);
-                assert(pAsmInsns);
-                const ResultValue* pAddr = pAsmInsns->GetTupleValue(_T("address"));
-                assert(pAddr);
-                const ResultValue* pfunc = pAsmInsns->GetTupleValue(_T("func-name"));
-                assert(pfunc);
-                const ResultValue* pOffset = pAsmInsns->GetTupleValue(_T("offset"));
-                assert(pOffset);
-                const ResultValue* pInst = pAsmInsns->GetTupleValue(_T("inst"));
-                assert(pInst);
-                unsigned long int addr;
-                pAddr->GetSimpleValue().ToULong(&addr, 16);
-                dialog->AddAssemblerLine(addr, pInst->GetSimpleValue());
-
-            }// for not mixedMode
-
+            Diagnostic(m_logger, Logger::Category::Disassembly)
+                << _T("GenerateAssembly::OnCommandOutput: tuple size ") << asm_insns.GetCount()
+                << (parsed ? _T("") : _T(" (malformed)"));
             dialog->CenterCurrentLine();
         }//endElse
     }//endElse if id == m_disassemble_info_id
@@ -1589,19 +1540,183 @@ void GenerateDisassembly::OnCommandOutput(CommandID const &id, ResultParser cons
     // parse error on malformed response
     if (result.GetParseError())
     {
-        m_logger.Debug(_T("GenerateDisassembly::OnCommandOutput: Malformed response parse error ") + id.ToString());
+        Diagnostic(m_logger, Logger::Category::Disassembly)
+            << _T("GenerateDisassembly::OnCommandOutput: Malformed response parse error ") << id;
         Finish();
     }// parse error
 }
+// ----------------------------------------------------------------------------
+bool GenerateDisassembly::ParseSourceAndAsmLine(ResultValue const &src_and_asm_line, int /*index*/)
+// ----------------------------------------------------------------------------
+{
+    // (gdb)
+    //- -data-disassemble -f basics.c -l 32 -n 3 -- 1
+    // -data-disassemble -s $pc -e "$pc + 20" -- 0
+    // ^done,asm_insns=[
+    // src_and_asm_line={line="31",
+    // file="/kwikemart/marge/ezannoni/flathead-dev/devo/gdb/
+    //   testsuite/gdb.mi/basics.c",line_asm_insn=[
+    // {address="0x000107bc",func-name="main",offset="0",
+    // inst="save  %sp, -112, %sp"}]},
+    // src_and_asm_line={line="32",
+    // file="/kwikemart/marge/ezannoni/flathead-dev/devo/gdb/
+    //   testsuite/gdb.mi/basics.c",line_asm_insn=[
+    // {address="0x000107c0",func-name="main",offset="4",
+    // inst="mov  2, %o0"},
+    // {address="0x000107c4",func-name="main",offset="8",
+    // inst="sethi  %hi(0x11800), %o2"}]}]
+    // (gdb)
+
+    const ResultValue* pLineNo = src_and_asm_line.GetTupleValue(Atom_line);
+    assert(pLineNo);
+    const ResultValue* pFile = src_and_asm_line.GetTupleValue(Atom_file);
+    assert(pFile);
+
+    const ResultValue* pLine_asm_insn = src_and_asm_line.GetTupleValue(Atom_line_asm_insn);
+    assert(pLine_asm_insn);
+
+    unsigned long int lineno ;
+    pLineNo->GetSimpleValue().ToULong(&lineno, 10) ;
+    // cb editors are 0 oriented, gdb is 1 oriented
+    //-if (lineno > 0) lineno -= 1;
+    //dialog->AddSourceLineByFile(lineno, pFile->GetSimpleValue());
+    AddSourceLineByFile(lineno, pFile->GetSimpleValue());
+
+    int laiKnt = pLine_asm_insn->GetTupleSize();
+    for ( int jj = 0; jj < laiKnt; ++jj)
+        ParseAsmInstruction(*pLine_asm_insn->GetTupleValueByIndex(jj), jj);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool GenerateDisassembly::ParseAsmInstruction(ResultValue const &asm_insn, int /*index*/)
+// ----------------------------------------------------------------------------
+{
+    // (gdb)
+    // -data-disassemble -s $pc -e "$pc + 20" -- 0
+    // ^done,
+    // asm_insns=[
+    // {address="0x000107c0",func-name="main",offset="4",
+    // inst="mov  2, %o0"},
+    // {address="0x000107c4",func-name="main",offset="8",
+    // inst="sethi  %hi(0x11800), %o2"},
+    // {address="0x000107c8",func-name="main",offset="12",
+    // inst="or  %o2, 0x140, %o1\t! 0x11940 <_lib_version+8>"},
+    // {address="0x000107cc",func-name="main",offset="16",
+    // inst="sethi  %hi(0x11800), %o2"},
+    // {address="0x000107d0",func-name="main",offset="20",
+    // inst="or  %o2, 0x168, %o4\t! 0x11968 <_lib_version+48>"}]
+    // (gdb)
+
+    const ResultValue* pAddr = asm_insn.GetTupleValue(Atom_address);
+    assert(pAddr);
+    const ResultValue* pfunc = asm_insn.GetTupleValue(Atom_func_name);
+    assert(pfunc);
+    const ResultValue* pOffset = asm_insn.GetTupleValue(Atom_offset);
+    assert(pOffset);
+    const ResultValue* pInst = asm_insn.GetTupleValue(Atom_inst);
+    assert(pInst);
+    unsigned long int addr;
+    pAddr->GetSimpleValue().ToULong(&addr, 16);
+    cbDisassemblyDlg *dialog = Manager::Get()->GetDebuggerManager()->GetDisassemblyDialog();
+    dialog->AddAssemblerLine(addr, pInst->GetSimpleValue());
+    return true;
+}
+
 // ----------------------------------------------------------------------------
 // implement class ExamineMemory : public Action
 // ----------------------------------------------------------------------------
+namespace
+{
+// Reports the bytes of memory=[{addr="..",data=["0x55",..]},..] to the dialog.
+class MemoryVisitor : public ResultVisitor
+{
+public:
+    explicit MemoryVisitor(cbExamineMemoryDlg *dialog) :
+        m_dialog(dialog),
+        m_depth(0),
+        m_in_memory(false),
+        m_in_data(false),
+        m_byteAddr(0),
+        m_bytesPerLine(0)
+    {
+    }
+
+    virtual bool OnTupleStart(Span const & /*name*/)
+    {
+        ++m_depth;
+        return true;
+    }
+    virtual bool OnTupleEnd()
+    {
+        --m_depth;
+        return true;
+    }
+    virtual bool OnListStart(Span const &name)
+    {
+        if(m_depth == 0 && FindAtom(name.data, name.length) == Atom_memory)
+            m_in_memory = true;
+        else if(m_in_memory && m_depth == 2 && FindAtom(name.data, name.length) == Atom_data)
+        {
+            m_in_data = true;
+            m_bytesPerLine = BYTES_TO_REPORT;
+            m_addrToReport = wxString::Format(_T("%#x"), m_byteAddr);
+        }
+        ++m_depth;
+        return true;
+    }
+    virtual bool OnListEnd()
+    {
+        --m_depth;
+        if(m_depth == 0)
+            m_in_memory = false;
+        else if(m_depth == 2)
+            m_in_data = false;
+        return true;
+    }
+    virtual bool OnValue(Span const &name, Span const &value)
+    {
+        if(m_in_memory && m_depth == 2 && FindAtom(name.data, name.length) == Atom_addr)
+        {
+            m_byteAddr = 0;
+            UnquoteValue(value).ToLong(&m_byteAddr, 16);
+        }
+        else if(m_in_data && m_depth == 3)
+        {
+            // the list items keep their quotes
+            wxString hexByte = value.ToString();
+            hexByte = hexByte.BeforeLast('\"');
+            hexByte = hexByte.AfterFirst('x');
+            if (m_bytesPerLine == 0)
+            {   m_addrToReport = wxString::Format(_T("%#x"), m_byteAddr);
+                m_bytesPerLine = BYTES_TO_REPORT;
+            }
+            m_dialog->AddHexByte(m_addrToReport, hexByte);
+            m_bytesPerLine -= 1;
+            m_byteAddr += 1;
+        }
+        return true;
+    }
+private:
+    // The cb Memory display is set up to accept lines of 8 bytes each
+    // So we'll report the address of every eight byte
+    static const int BYTES_TO_REPORT = 8;
+
+    cbExamineMemoryDlg *m_dialog;
+    int m_depth;
+    bool m_in_memory, m_in_data;
+    long m_byteAddr;
+    int m_bytesPerLine;
+    wxString m_addrToReport;
+};
+} // anonymous namespace
+
 // only tested on mingw/pc/win env
 ExamineMemory::ExamineMemory(Logger &logger) :
             m_logger(logger),
             m_parsed_memory_values(false)
 {
-    //ctor
+    SetPriority(PriorityBackground);
 }
 ExamineMemory::~ExamineMemory()
 {
@@ -1624,10 +1739,10 @@ void ExamineMemory::OnCommandOutput(CommandID const &id, ResultParser const &res
 
         m_parsed_memory_values = true;
 
-        const ResultValue* pMemory = result.GetResultValue().GetTupleValue(_T("memory"));
-        if(not pMemory)
+        if(not result.GetResultValue().GetTupleValue(Atom_memory))
         {
-            m_logger.Debug(_T("ExamineMemory::OnCommandOutput: no 'memory' tuple in the output"));
+            Diagnostic(m_logger, Logger::Category::Memory)
+                << _T("ExamineMemory::OnCommandOutput: no 'memory' tuple in the output");
             Finish();
             return;
         }
@@ -1636,44 +1751,11 @@ void ExamineMemory::OnCommandOutput(CommandID const &id, ResultParser const &res
         dialog->Begin();
         dialog->Clear();
 
-        int isize = pMemory->GetTupleSize();
-        //m_logger.Debug(wxString::Format(_T("ExamineMemory::OnCommandOutput: tuple size %d %s"),
-        //                                isize, pMemory->MakeDebugString().c_str()));
-
-        for(int ii = 0; ii < isize; ++ii)
-        {
-            const ResultValue* pentry = pMemory->GetTupleValueByIndex(ii);
-            assert(pentry);
-            const ResultValue* pAddr_tuple = pentry->GetTupleValue(_T("addr"));
-            assert(pAddr_tuple);
-            const ResultValue* pData_tuple =  pentry->GetTupleValue(_T("data"));
-            assert(pData_tuple);
-            int jsize = pData_tuple->GetTupleSize();
-
-            // The cb Memory display is set up to accept lines of 8 bytes each
-            // So we'll report the address of every eight byte
-            const int BYTES_TO_REPORT = 8;
-            long byteAddr = 0;
-            pAddr_tuple->GetSimpleValue().ToLong(&byteAddr,16);
-            int bytesPerLine = BYTES_TO_REPORT;
-            wxString addrToReport = wxString::Format(_T("%#x"), byteAddr);
-            for (int jj = 0; jj<jsize; ++jj)
-            {
-                const ResultValue* pdata_value = pData_tuple->GetTupleValueByIndex(jj);
-                assert(pdata_value);
-                wxString hexByte = pdata_value->GetSimpleValue();
-                hexByte = hexByte.BeforeLast('\"');
-                hexByte = hexByte.AfterFirst('x');
-                if (bytesPerLine == 0)
-                {   addrToReport = wxString::Format(_T("%#x"), byteAddr);
-                    bytesPerLine = BYTES_TO_REPORT;
-                    //m_logger.Debug(wxString::Format(_T("addrToReport[%s]"),addrToReport.c_str()));
-                }
-                dialog->AddHexByte(addrToReport, hexByte);
-                bytesPerLine -= 1;
-                byteAddr += 1;
-            }
-        }
+        // the bytes go to the dialog as they are parsed, the 'data' lists are never built
+        MemoryVisitor memory(dialog);
+        if(not result.Visit(memory))
+            Diagnostic(m_logger, Logger::Category::Memory)
+                << _T("ExamineMemory::OnCommandOutput: malformed 'memory' list");
         dialog->End();
         Finish();
     }
@@ -5,6 +5,7 @@
 #include<unordered_map>
 #include "cmd_queue.h"
 #include "definitions.h"
+#include "diagnostics.h"
 #include "cbplugin.h"
 #include <infowindow.h>
 #include "helpers.h"
@@ -14,6 +15,11 @@
 namespace dbg_mi
 {
 
+class Frame;
+class UpdatedVariable;
+class VarObjectInfo;
+struct DecodedFields;
+
 // ----------------------------------------------------------------------------
 class SimpleAction : public Action
 // ----------------------------------------------------------------------------
@@ -74,7 +80,7 @@ public:
     }
     virtual ~BreakpointAddAction()
     {
-        m_logger.Debug(_T("BreakpointAddAction::destructor"));
+        Diagnostic(m_logger, Logger::Category::Breakpoints) << _T("BreakpointAddAction::destructor");
     }
     virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
 protected:
@@ -105,7 +111,7 @@ public:
     }
     virtual ~RunAction()
     {
-        m_logger.Debug(_T("RunAction::destructor"));
+        Diagnostic(m_logger, Logger::Category::Run) << _T("RunAction::destructor");
     }
 
     //-virtual void OnCommandOutput(CommandID const &/*id*/, ResultParser const &result)
@@ -114,8 +120,9 @@ public:
         wxUnusedVar(id);
         if(result.GetResultClass() == ResultParser::ClassRunning)
         {
-            m_logger.Debug(_T("RunAction success, the debugger is !stopped!"));
-            m_logger.Debug(_T("RunAction::Output - ") + result.MakeDebugString());
+            Diagnostic(m_logger, Logger::Category::Run) << _T("RunAction success, the debugger is !stopped!");
+            Diagnostic(m_logger, Logger::Category::Run, Logger::Verbosity::Trace)
+                << _T("RunAction::Output - ") << result;
             m_notification(false);
         }
 
@@ -125,7 +132,7 @@ protected:
     virtual void OnStart()
     {
         Execute(m_command);
-        m_logger.Debug(_T("RunAction::OnStart -> ") + m_command);
+        Diagnostic(m_logger, Logger::Category::Run) << _T("RunAction::OnStart -> ") << m_command;
     }
 
 private:
@@ -155,6 +162,8 @@ public:
     virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
 protected:
     virtual void OnStart();
+private:
+    bool ParseStackFrame(Frame &frame, DecodedFields const &fields, int index);
 private:
     SwitchToFrameInvoker *m_switch_to_frame;
     CommandID m_backtrace_id, m_args_id, m_frame_info_id;
@@ -222,6 +231,8 @@ public:
         m_notification(notification),
         m_user_action(user_action)
     {
+        if(user_action)
+            SetPriority(PriorityInteractive);
     }
 
     virtual void OnCommandOutput(CommandID const &/*id*/, ResultParser const &result)
@@ -252,9 +263,12 @@ public:
 protected:
     void ExecuteListCommand(Watch::Pointer watch, Watch::Pointer parent = Watch::Pointer());
     void ExecuteListCommand(wxString const &watch_id, Watch::Pointer parent);
-    bool ParseListCommand(CommandID const &id, ResultValue const &value);
+    bool ParseListCommand(CommandID const &id, ResultParser const &result);
 
     void SetRange(int start, int end) { m_start = start; m_end = end; }
+private:
+    class ChildrenVisitor;
+    bool ParseListChild(Watch::Pointer parent_watch, VarObjectInfo const &child_info);
 protected:
     typedef std::unordered_map<CommandID, Watch::Pointer> ListCommandParentMap;
 protected:
@@ -295,6 +309,7 @@ public:
         WatchCreateAction(watch, watches, logger),
         m_rect(rect)
     {
+        SetPriority(PriorityInteractive);
     }
     virtual ~WatchCreateTooltipAction();
 private:
@@ -308,6 +323,10 @@ class WatchesUpdateAction : public WatchBaseAction
 public:
     WatchesUpdateAction(WatchesContainer &watches, Logger &logger);
     WatchesUpdateAction(WatchesContainer &watches, Logger &logger, Watch::Pointer singleWatch); // single watch
+    // Only these var objects and their children which aren't frozen, by name.
+    // 'in_flight_limit' is the executor's, the commands are sent all at once without one.
+    WatchesUpdateAction(WatchesContainer &watches, Logger &logger, wxArrayString const &names,
+                        int in_flight_limit);
 
     virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
 protected:
@@ -315,8 +334,10 @@ protected:
 
 private:
     bool ParseUpdate(ResultParser const &result);
+    bool ParseUpdatedVariable(UpdatedVariable &updated_var, DecodedFields const &fields, int index);
 private:
-    CommandID   m_update_command;
+    std::vector<CommandID> m_update_commands;
+    wxArrayString m_names;
     Watch::Pointer watch;
 };
 
@@ -369,6 +390,7 @@ public:
         if (parent_watch->IsArray()) // implement edit Watches IsArray()
             SetRange(parent_watch->GetArrayStart(),
                         parent_watch->GetArrayStart()+parent_watch->GetArrayCount());
+        SetPriority(PriorityInteractive);
     }
 
     virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
@@ -392,6 +414,7 @@ public:
         m_watch(parent_watch),
         m_collapsed_watch(collapsed_watch)
     {
+        SetPriority(PriorityInteractive);
     }
 
     virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
@@ -451,6 +474,9 @@ class GenerateDisassembly : public Action
         virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
     protected:
         virtual void OnStart();
+    private:
+        bool ParseSourceAndAsmLine(ResultValue const &src_and_asm_line, int index);
+        bool ParseAsmInstruction(ResultValue const &asm_insn, int index);
 };
 // ----------------------------------------------------------------------------
 class ExamineMemory : public Action
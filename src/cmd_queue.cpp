@@ -1,67 +1,230 @@
 #include "cmd_queue.h"
 
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "session_recorder.h"
+
 // ----------------------------------------------------------------------------
 namespace dbg_mi
 // ----------------------------------------------------------------------------
 {
 
-bool ParseGDBOutputLine(wxString const &line, CommandID &id, wxString &result_str)
+bool ParseGDBOutputLine(std::string const &line, CommandID &id, RecordHeader &header)
+{
+    if(not DecodeRecordHeader(line.data(), line.length(), header))
+        return false;
+    id = header.has_token ? CommandID(header.action, header.command) : CommandID();
+    return true;
+}
+
+// The notifications GDB sends in bursts (a program loading its shared libraries or starting
+// its threads); they are only logged, so a burst is handled once.
+static bool IsCoalescedNotification(std::string const &record, RecordHeader const &header)
 {
-    size_t pos = 0;
-    while(pos < line.length() && wxIsdigit(line[pos]))
-        ++pos;
-    if(pos <= 10)
+    if(header.type != ResultParser::NotifyAsyncOutput || record.length() < static_cast<size_t>(header.class_end))
+        return false;
+
+    static char const *const names[] =
     {
-        if(pos != 0)
-            return false;
-        if(line[0] == _T('*') || line[0] == _T('^') || line[0] == _T('+') || line[0] == _T('='))
-        {
-            id = CommandID();
-            result_str = line;
+        "library-loaded",
+        "library-unloaded",
+        "thread-created",
+        "thread-exited"
+    };
+    Span name(record.data() + header.prefix_pos + 1, header.class_end - header.prefix_pos - 1);
+    for(size_t ii = 0; ii < sizeof(names) / sizeof(names[0]); ++ii)
+    {
+        if(name == Span(names[ii], static_cast<int>(std::strlen(names[ii]))))
             return true;
-        }
-        else
-            return false;
     }
-    else
-    {
-        long action_id, cmd_id;
-
-        wxString const &str_action = line.substr(0, pos - 10);
-        str_action.ToLong(&action_id, 10);
-
-        wxString const &str_cmd = line.substr(pos - 10, 10);
-        str_cmd.ToLong(&cmd_id, 10);
+    return false;
+}
 
-        id = dbg_mi::CommandID(action_id, cmd_id);
-        result_str = line.substr(pos, line.length() - pos);
-        return true;
-    }
+static bool IsSameNotification(CommandExecutor::Result const &batch, CommandExecutor::Result const &r)
+{
+    if(batch.parser || batch.header.class_end != r.header.class_end)
+        return false;
+    return batch.record.compare(0, batch.header.class_end, r.record, 0, r.header.class_end) == 0;
 }
 
 CommandID CommandExecutor::Execute(wxString const &cmd)
 {
+    FlushCommands(); // keep the order of the commands
     dbg_mi::CommandID id(0, m_last++);
+    InFlightCommand command;
+    command.id = id;
+    command.verb = CommandStats::GetVerb(cmd);
+    if(m_timings)
+        command.command = cmd;
+    command.stamps.sent = CommandStats::Now();
+    m_in_flight.push_back(command);
+    if(m_recorder)
+        m_recorder->RecordCommand(command.stamps.sent, id, cmd);
     if(m_logger)
     {
-        m_logger->Debug(_T("cmd==>") + id.ToString() + cmd, Logger::Line::Command);
+        if(m_logger->IsDebugEnabled(Logger::Line::Command))
+            m_logger->Debug(_T("cmd==>") + id.ToString() + cmd, Logger::Line::Command);
         m_logger->AddCommand(id.ToString() + cmd);
     }
 
     if(DoExecute(id, cmd))
+    {
+        CountWrite(1);
         return id;
+    }
     else
         return dbg_mi::CommandID();
 }
 void CommandExecutor::ExecuteSimple(dbg_mi::CommandID const &id, wxString const &cmd)
 {
+    InFlightCommand command;
+    command.id = id;
+    command.verb = CommandStats::GetVerb(cmd);
+    if(m_timings)
+        command.command = cmd;
+    command.stamps.sent = CommandStats::Now(); // the batch is written within this pass
+    m_in_flight.push_back(command);
+    if(m_recorder)
+        m_recorder->RecordCommand(command.stamps.sent, id, cmd);
+    if(m_write_policy == WriteEachCommand)
+    {
+        if(m_logger)
+        {
+            if(m_logger->IsDebugEnabled(Logger::Line::Command))
+                m_logger->Debug(_T("cmd==>") + id.ToString() + cmd, Logger::Line::Command);
+            m_logger->AddCommand(id.ToString() + cmd);
+        }
+        if(DoExecute(id, cmd))
+            CountWrite(1);
+        return;
+    }
+
+    wxString line = id.ToString() + cmd;
+    if(m_batch_count > 0)
+        m_batch += _T('\n');
+    m_batch += line;
     if(m_logger)
     {
-        m_logger->Debug(_T("cmd==>") + id.ToString() + cmd, Logger::Line::Command);
-        m_logger->AddCommand(id.ToString() + cmd);
+        if(m_logger->IsDebugEnabled(Logger::Line::Command))
+        {
+            if(not m_batch_log.empty())
+                m_batch_log += _T('\n');
+            m_batch_log += _T("cmd==>") + line;
+        }
+        m_logger->AddCommand(line);
     }
-    DoExecute(id, cmd);
 
+    if(++m_batch_count >= m_max_batch)
+        FlushCommands();
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::FlushCommands()
+// ----------------------------------------------------------------------------
+{
+    if(m_batch_count == 0)
+        return;
+
+    // one log entry per write too
+    if(m_logger && not m_batch_log.empty())
+    {
+        if(m_batch_count > 1)
+            m_batch_log += wxString::Format(_T("\n(%d commands in one write)"), m_batch_count);
+        m_logger->Debug(m_batch_log, Logger::Line::Command);
+    }
+    if(DoExecuteBatch(m_batch, m_batch_count))
+        CountWrite(m_batch_count);
+
+    m_batch.clear();
+    m_batch_log.clear();
+    m_batch_count = 0;
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::SetWritePolicy(WritePolicy policy, int max_batch)
+// ----------------------------------------------------------------------------
+{
+    FlushCommands();
+    m_write_policy = policy;
+    m_max_batch = max_batch > 0 ? max_batch : 1;
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::CommandDone(Result const &r, ResultParser const &parser)
+// ----------------------------------------------------------------------------
+{
+    m_has_dispatched = false;
+    // the results come mostly in order, the search stops at the front
+    for(InFlight::iterator it = m_in_flight.begin(); it != m_in_flight.end(); ++it)
+    {
+        if(it->id == r.id)
+        {
+            m_dispatched = *it;
+            m_dispatched.stamps.received = r.received;
+            m_dispatched.stamps.parse_start = r.parse_start;
+            m_dispatched.stamps.parse_end = r.parse_end;
+            if(parser.HasTimings())
+            {
+                GDBTimings const &timings = parser.GetTimings();
+                m_dispatched.stamps.gdb_wallclock = timings.wallclock;
+                m_dispatched.stamps.gdb_cpu = timings.user + timings.system;
+                m_dispatched.stamps.gdb_timed = true;
+            }
+            m_has_dispatched = true;
+            m_in_flight.erase(it);
+            return;
+        }
+    }
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::StampCallback()
+// ----------------------------------------------------------------------------
+{
+    if(m_has_dispatched)
+        m_dispatched.stamps.callback = CommandStats::Now();
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::StampCallbackEnd(Action const *action)
+// ----------------------------------------------------------------------------
+{
+    if(not m_has_dispatched)
+        return;
+    CommandStats::Stamps &stamps = m_dispatched.stamps;
+    stamps.callback_end = CommandStats::Now();
+    stamps.finished = action && action->Finished();
+    m_stats.Add(m_dispatched.verb, stamps);
+    m_has_dispatched = false;
+
+    if(m_logger && stamps.gdb_timed && stamps.gdb_wallclock >= m_slow_command_us)
+    {
+        wxString line = wxString::Format(_T("slow command: %lld ms in GDB (cpu %lld ms), %s%s"),
+                                         (long long)(stamps.gdb_wallclock / 1000),
+                                         (long long)(stamps.gdb_cpu / 1000),
+                                         m_dispatched.id.ToString().c_str(),
+                                         m_dispatched.command.c_str());
+        if(action)
+        {
+            line += wxString::Format(_T(" [action %d: %lld ms in GDB over %d commands]"), action->GetID(),
+                                     (long long)(action->GetGDBTime().wallclock / 1000),
+                                     action->GetTimedCommandsCount());
+        }
+        m_logger->Debug(line, Logger::Line::Debug);
+    }
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::SetTimings(bool enabled, int slow_command_ms)
+// ----------------------------------------------------------------------------
+{
+    m_timings = enabled;
+    m_slow_command_us = int64_t(slow_command_ms > 0 ? slow_command_ms : 0) * 1000;
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::CountWrite(int count)
+// ----------------------------------------------------------------------------
+{
+    ++m_writes;
+    m_written_commands += count;
+    if(count > m_largest_write)
+        m_largest_write = count;
 }
 /***
 All output sequences end in a single line containing a period.
@@ -133,15 +296,63 @@ The following is a preliminary list of possible out-of-band records.
 bool CommandExecutor::ProcessOutput(wxString const &output)
 // ----------------------------------------------------------------------------
 {
-    dbg_mi::CommandID id;
-    Result r;
+    wxScopedCharBuffer utf8 = output.utf8_str();
+    return ProcessOutput(utf8.data(), utf8.length());
+}
+// ----------------------------------------------------------------------------
+bool CommandExecutor::ProcessOutput(char const *line, int length)
+// ----------------------------------------------------------------------------
+{
+    OutputLine output;
+    DecodeOutput(line, length, output, false);
+    return ProcessOutput(output);
+}
+// ----------------------------------------------------------------------------
+void CommandExecutor::DecodeOutput(char const *line, int length, OutputLine &output, bool parse)
+// ----------------------------------------------------------------------------
+{
+    Result &r = output.result;
+    r.received = CommandStats::Now();
+    // the line is copied once, the parser takes over these bytes
+    r.record.assign(line, length);
+    output.text = wxString::FromUTF8(line, length);
+    output.is_record = dbg_mi::ParseGDBOutputLine(r.record, r.id, r.header);
+    if(not output.is_record)
+        return;
+
+    std::string const &record = r.record;
+    output.is_error = record.find("No symbol table loaded") != std::string::npos
+                      || record.find("No executable file specified") != std::string::npos
+                      || record.find("No executable specified") != std::string::npos
+                      || record.find("Don't know how to run") != std::string::npos;
+                      //- || output.Contains(_("error,msg=")) // (ph 25/08/31)
+                      // allow the error msg above
+                      // newer GDB uses the above when var is out of scope
+
+    // the first of a burst is parsed on demand, the others are only counted
+    if(parse && not IsCoalescedNotification(record, r.header))
+    {
+        r.parse_start = CommandStats::Now();
+        r.parser = new ResultParser;
+        // all of the record is decoded here, not on the GUI thread when it's accessed
+        r.parser->SetLazy(false);
+        r.parser->Parse(r.record, r.header);
+        r.parse_end = CommandStats::Now();
+    }
+}
+// ----------------------------------------------------------------------------
+bool CommandExecutor::ProcessOutput(OutputLine &output)
+// ----------------------------------------------------------------------------
+{
+    if(m_recorder)
+        m_recorder->RecordOutput(output.result.received, output.text);
 
     if(m_logger)
     {
-        if(not dbg_mi::ParseGDBOutputLine(output, r.id, r.output))
+        if(not output.is_record)
         {
             // a beginning '&' means an error msg from GDB
-            if (output.Length() and (output[0] == '&'))     //(ph 2024/04/12)
+            if (output.text.Length() and (output.text[0] == '&'))     //(ph 2024/04/12)
             {
                 // These errors are useless //(ph 2024/05/07)
 
@@ -154,43 +365,89 @@ bool CommandExecutor::ProcessOutput(wxString const &output)
                 //     SetRunActionMsg(filteredOutput, "GDB/MI error", errInfo );
                 // }
             }
-            else
-                m_logger->Debug(_T("unparsable_output==>") + output, Logger::Line::Unknown);
+            else if(m_logger->IsDebugEnabled(Logger::Line::Unknown))
+                m_logger->Debug(_T("unparsable_output==>") + output.text, Logger::Line::Unknown);
 
             return false;
         }
         else //parse is ok
         {
-            if (   output.Contains(_("No symbol table loaded"))
-                    || output.Contains(_("No executable file specified"))
-                    || output.Contains(_("No executable specified"))
-                    || output.Contains(_("Don't know how to run"))
-                    //- || output.Contains(_("error,msg=")) // (ph 25/08/31)
-                    // allow the error msg above
-                    // newer GDB uses the above when var is out of scope
-                )
+            if (output.is_error)
             {
-                m_logger->Debug(_T("output==>") + output, Logger::Line::Error); // (ph 25/05/14)
+                m_logger->Debug(_T("output==>") + output.text, Logger::Line::Error); // (ph 25/05/14)
                 Logger::Line::Type lineType = Logger::Line::Error;
-                wxString filteredOutput = output;
+                wxString filteredOutput = output.text;
                 lineType = GetFilteredOutputError(filteredOutput, lineType);
                 SetRunActionMsg(filteredOutput, "GDB/MI error", errAbort );
 
             }
-            else
-                m_logger->Debug(_T("output==>") + output, Logger::Line::CommandResult);
+            else if(m_logger->IsDebugEnabled(Logger::Line::CommandResult))
+                m_logger->Debug(_T("output==>") + output.text, Logger::Line::CommandResult);
         }
     }
     else // no m_logger
     {
-        if(not dbg_mi::ParseGDBOutputLine(output, r.id, r.output))
+        if(not output.is_record)
             return false;
     }
 
-    m_results.push_back(r);
+    return QueueResult(output.result);
+}
+// ----------------------------------------------------------------------------
+bool CommandExecutor::QueueResult(Result &r)
+// ----------------------------------------------------------------------------
+{
+    // a record parsed by the reader thread has given its bytes to the parser,
+    // it's never one of the coalesced notifications
+    bool coalesced = not r.parser && IsCoalescedNotification(r.record, r.header);
+    if(coalesced && not m_results.empty() && IsSameNotification(m_results.back(), r))
+    {
+        ++m_results.back().count;
+        return true;
+    }
+
+    // only the bursts and the status records, the plugin acts on the other notifications
+    bool droppable = coalesced || r.header.type == ResultParser::StatusAsyncOutput;
+    if(droppable && m_results.size() >= m_results_capacity)
+    {
+        if(m_dropped_notifications++ == 0 && m_logger)
+        {
+            m_logger->Debug(wxString::Format(_T("results queue is full (%lu), dropping notifications"),
+                                             static_cast<unsigned long>(m_results.size())),
+                            Logger::Line::Error);
+        }
+        return false;
+    }
+
+    m_results.push_back(std::move(r));
+    r.parser = NULL; // owned by m_results now
+
+    // the queue grows by one, so each power of 2 of the high-water mark is reported
+    size_t size = m_results.size();
+    if(size > m_results_high_water)
+    {
+        m_results_high_water = size;
+        if(size >= 64 && (size & (size - 1)) == 0 && m_logger)
+        {
+            m_logger->Debug(wxString::Format(_T("results queue high-water mark: %lu"),
+                                             static_cast<unsigned long>(size)));
+        }
+    }
     return true;
 }
 // ----------------------------------------------------------------------------
+void CommandExecutor::ReportDroppedNotifications()
+// ----------------------------------------------------------------------------
+{
+    if(m_logger)
+    {
+        m_logger->Debug(wxString::Format(_T("results queue drained, %d notifications were dropped"),
+                                         m_dropped_notifications),
+                        Logger::Line::Error);
+    }
+    m_dropped_notifications = 0;
+}
+// ----------------------------------------------------------------------------
 Logger::Line::Type CommandExecutor::GetFilteredOutputError(wxString& output, Logger::Line::Type lineType)
 // ----------------------------------------------------------------------------
 {
@@ -226,12 +483,23 @@ void CommandExecutor::Clear()
 // ----------------------------------------------------------------------------
 {
     m_last = 0;
+    for(Results::iterator it = m_results.begin(); it != m_results.end(); ++it)
+        delete it->parser;
     m_results.clear();
+    m_results_high_water = 0;
+    m_dropped_notifications = 0;
+    m_batch.clear();
+    m_batch_log.clear();
+    m_batch_count = 0;
+    m_in_flight.clear();
+    m_has_dispatched = false;
 
     DoClear();
 }
 
 ActionsMap::ActionsMap() :
+    m_first_slot_id(1),
+    m_count(0),
     m_last_id(1)
 {
 }
@@ -245,27 +513,43 @@ ActionsMap::~ActionsMap()
 void ActionsMap::Add(Action *action)
 {
     action->SetID(m_last_id++);
-    m_actions.push_back(action);
+    assert(action->GetID() - m_first_slot_id == static_cast<int>(m_slots.size()));
+    Slot slot;
+    slot.action = action;
+    slot.position = m_actions.insert(m_actions.end(), action);
+    m_slots.push_back(slot);
+    ++m_count;
 }
 
 Action* ActionsMap::Find(int id)
 {
-    for(Actions::iterator it = m_actions.begin(); it != m_actions.end(); ++it)
-    {
-        if((*it)->GetID() == id)
-            return *it;
-    }
-    return NULL;
+    int index = id - m_first_slot_id;
+    if(index < 0 || index >= static_cast<int>(m_slots.size()))
+        return NULL;
+    return m_slots[index].action;
 }
 
 Action const * ActionsMap::Find(int id) const
 {
-    for(Actions::const_iterator it = m_actions.begin(); it != m_actions.end(); ++it)
+    int index = id - m_first_slot_id;
+    if(index < 0 || index >= static_cast<int>(m_slots.size()))
+        return NULL;
+    return m_slots[index].action;
+}
+
+// Deletes the action, returns the position of the next one.
+ActionsMap::Actions::iterator ActionsMap::Remove(Actions::iterator it)
+{
+    Action *action = *it;
+    m_slots[action->GetID() - m_first_slot_id].action = NULL;
+    while(not m_slots.empty() && m_slots.front().action == NULL)
     {
-        if((*it)->GetID() == id)
-            return *it;
+        m_slots.pop_front();
+        ++m_first_slot_id;
     }
-    return NULL;
+    --m_count;
+    delete action;
+    return m_actions.erase(it);
 }
 
 void ActionsMap::Clear()
@@ -273,6 +557,9 @@ void ActionsMap::Clear()
     for(Actions::iterator it = m_actions.begin(); it != m_actions.end(); ++it)
         delete *it;
     m_actions.clear();
+    m_slots.clear();
+    m_first_slot_id = 1;
+    m_count = 0;
     m_last_id = 1;
 }
 
@@ -286,8 +573,12 @@ void ActionsMap::Run(CommandExecutor &executor)
 
     Logger *logger = executor.GetLogger();
 
-    bool first = true;
-    for(Actions::iterator it = m_actions.begin(); it != m_actions.end(); )
+    // start the actions in front of the first barrier, the finished ones are removed
+    // once their last commands went out in their place
+    std::vector<Action*> ready;
+    int wanted = 0;
+    bool first = true; // the actions before are all finished
+    for(Actions::iterator it = m_actions.begin(); it != m_actions.end(); ++it)
     {
         Action &action = **it;
 
@@ -297,7 +588,7 @@ void ActionsMap::Run(CommandExecutor &executor)
 
         if(not action.Started())
         {
-            if(logger)
+            if(logger && logger->IsDebugEnabled())
             {
                 logger->Debug(wxString::Format(_T("ActionsMap::Run -> starting action: %p id: %d"),
                                                &action, action.GetID()),
@@ -306,34 +597,67 @@ void ActionsMap::Run(CommandExecutor &executor)
             action.Start();
         }
 
-        while(action.HasPendingCommands())
-        {
-            CommandID id;
-            wxString const &command = action.PopPendingCommand(id);
-            executor.ExecuteSimple(id, command);
-        }
+        wanted += action.Finished() ? action.GetPendingCommandsCount() : action.GetReadyCommandsCount();
+        first = first && action.Finished();
+        ready.push_back(&action);
+    }//for
 
-        first = false;
-        if(not action.Finished())
-        {
-            ++it;
-            //-SetDebugMark(false);
-        }
-        else
+    // The commands go out in the order of the actions while they fit in the in-flight window.
+    // Only when they don't the interactive actions get the room first, the background ones
+    // leave a quarter of the window to the interactive commands to come.
+    int limit = executor.GetInFlightLimit();
+    bool by_priority = limit > 0 && executor.GetInFlightCount() + wanted > limit;
+    int background_limit = limit - limit / 4;
+    int last_priority = by_priority ? Action::PriorityBackground : Action::PriorityInteractive;
+    for(int priority = Action::PriorityInteractive; priority <= last_priority; ++priority)
+    {
+        for(size_t ii = 0; ii < ready.size(); ++ii)
         {
-            if(logger && action.HasPendingCommands())
+            Action &action = *ready[ii];
+            if(by_priority && action.GetPriority() != priority)
+                continue;
+            if(action.Finished())
             {
-                logger->Debug(wxString::Format(_T("ActionsMap::Run -> action[%p id: %d] ")
-                                               _T("has pending commands but is being removed"),
-                                               &action, action.GetID()),
-                              Logger::Line::Debug);
+                if(logger && action.HasPendingCommands() && logger->IsDebugEnabled())
+                {
+                    logger->Debug(wxString::Format(_T("ActionsMap::Run -> action[%p id: %d] ")
+                                                   _T("has pending commands but is being removed"),
+                                                   &action, action.GetID()),
+                                  Logger::Line::Debug);
+                }
+                // nobody waits for the results, but the commands still go out like they always did
+                while(action.HasPendingCommands())
+                {
+                    CommandID id;
+                    wxString const &command = action.PopPendingCommand(id);
+                    executor.ExecuteSimple(id, command);
+                }
+                continue;
+            }
+            while(action.HasPendingCommands() && action.CanSendCommand() && executor.CanSendCommand())
+            {
+                if(by_priority && priority == Action::PriorityBackground
+                   && executor.GetInFlightCount() >= background_limit)
+                    break;
+                CommandID id;
+                wxString const &command = action.PopPendingCommand(id);
+                executor.ExecuteSimple(id, command);
             }
-            delete *it;
-            it = m_actions.erase(it);
-            if (it == m_actions.begin())
-                first = true;
         }
-    }//for
+    }
+
+    // 'ready' is the front of m_actions
+    Actions::iterator it = m_actions.begin();
+    for(size_t ii = 0; ii < ready.size(); ++ii)
+    {
+        if(ready[ii]->Finished())
+            it = Remove(it);
+        else
+            ++it;
+    }
+
+    // the commands of this pass go out in one write
+    executor.FlushCommands();
 }
 
 } // namespace dbg_mi
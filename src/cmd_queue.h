@@ -3,11 +3,14 @@
 
 
 #include <deque>
+#include <list>
 #include <ostream>
+#include <string>
 
 #include <wx/string.h>
 
 #include "cmd_result_parser.h"
+#include "command_stats.h"
 #include "globals.h"
 #include "helpers.h"
 #include "infowindow.h"
@@ -21,6 +24,8 @@ class PipedProcess;
 namespace dbg_mi
 {
 
+class SessionRecorder;
+
 // ----------------------------------------------------------------------------
 class Logger
 // ----------------------------------------------------------------------------
@@ -50,16 +55,51 @@ public:
             Error
         };
     };
+
+    // The debug lines of the actions are grouped by what they are about,
+    // every group has its own verbosity.
+    struct Category
+    {
+        enum Type
+        {
+            Breakpoints = 0,
+            Backtrace,
+            Threads,
+            Watches,
+            Registers,
+            Disassembly,
+            Memory,
+            Run,
+            Count
+        };
+    };
+
+    struct Verbosity
+    {
+        enum Type
+        {
+            Quiet = 0,
+            Normal,
+            Trace       // + the dumps of whole results
+        };
+    };
 public:
     virtual ~Logger() {}
 
     virtual void Log(wxString const &line, Log::Type type = Log::Normal) = 0;
     virtual void Debug(wxString const &line, Line::Type type = Line::Debug) = 0;
+    // Checked before formatting a debug line that is expensive to build
+    virtual bool IsDebugEnabled(Line::Type WXUNUSED(type) = Line::Debug) const { return true; }
+    virtual Verbosity::Type GetVerbosity(Category::Type WXUNUSED(category)) const { return Verbosity::Normal; }
+    bool IsDebugEnabled(Category::Type category, Verbosity::Type verbosity) const
+    {
+        return verbosity <= GetVerbosity(category) and IsDebugEnabled();
+    }
     virtual Line const* GetDebugLine(int index) const = 0;
 
     virtual void AddCommand(wxString const &command) = 0;
     virtual int GetCommandCount() const = 0;
-    virtual wxString const& GetCommand(int index) const = 0;
+    virtual wxString GetCommand(int index) const = 0;
     virtual void ClearCommand() = 0;
 };
 
@@ -130,7 +170,8 @@ inline std::ostream& operator<< (std::ostream& s, CommandID const &id)
 }
 
 // ----------------------------------------------------------------------------
-bool ParseGDBOutputLine(wxString const &line, CommandID &id, wxString &result_str);
+// Decodes the header of a UTF-8 output line, the token becomes 'id'.
+bool ParseGDBOutputLine(std::string const &line, CommandID &id, RecordHeader &header);
 // ----------------------------------------------------------------------------
 
 // ----------------------------------------------------------------------------
@@ -150,13 +191,25 @@ class Action
         int id;
     };
     typedef std::deque<Command> PendingCommands;
+public:
+    // The commands of the interactive actions are sent first when the in-flight window is full
+    enum Priority
+    {
+        PriorityInteractive = 0,    // tooltips, frame switches, watch expansion
+        PriorityNormal,
+        PriorityBackground          // registers, disassembly, memory
+    };
 public:
     Action() :
         m_id(-1),
         m_last_command_id(0),
+        m_priority(PriorityNormal),
+        m_max_in_flight(0),
+        m_in_flight(0),
         m_started(false),
         m_finished(false),
-        m_wait_previous(false)
+        m_wait_previous(false),
+        m_timed_commands(0)
     {
     }
 
@@ -182,6 +235,28 @@ public:
     void SetWaitPrevious(bool flag) { m_wait_previous = flag; }
     bool GetWaitPrevious() const { return m_wait_previous; }
 
+    void SetPriority(Priority priority) { m_priority = priority; }
+    Priority GetPriority() const { return m_priority; }
+
+    // At most 'count' commands of this action wait for their result, 0 is no limit
+    void SetMaxInFlight(int count) { m_max_in_flight = count; }
+    int GetInFlight() const { return m_in_flight; }
+    bool CanSendCommand() const { return m_max_in_flight <= 0 || m_in_flight < m_max_in_flight; }
+    // The pending commands the limit of the action lets out now
+    int GetReadyCommandsCount() const
+    {
+        int count = m_pending_commands.size();
+        if(m_max_in_flight > 0 && count > m_max_in_flight - m_in_flight)
+            count = m_in_flight < m_max_in_flight ? m_max_in_flight - m_in_flight : 0;
+        return count;
+    }
+    // the result record of one of the commands has arrived
+    void CommandDone()
+    {
+        if(m_in_flight > 0)
+            --m_in_flight;
+    }
+
     CommandID Execute(wxString const &command)
     {
         m_pending_commands.push_back(Command(command, m_last_command_id));
@@ -196,11 +271,22 @@ public:
         assert(HasPendingCommands());
         Command cmd = m_pending_commands.front();
         m_pending_commands.pop_front();
+        ++m_in_flight;
 
         id = CommandID(GetID(), cmd.id);
         return cmd.string;
     }
 
+    // The time GDB spent on the commands of this action, reported with -enable-timings
+    void AddGDBTime(GDBTimings const &timings)
+    {
+        m_gdb_time.wallclock += timings.wallclock;
+        m_gdb_time.user += timings.user;
+        m_gdb_time.system += timings.system;
+        ++m_timed_commands;
+    }
+    GDBTimings const & GetGDBTime() const { return m_gdb_time; }
+    int GetTimedCommandsCount() const { return m_timed_commands; }
 
 public:
     virtual void OnCommandOutput(CommandID const &id, ResultParser const &result) = 0;
@@ -210,9 +296,14 @@ private:
     PendingCommands m_pending_commands;
     int m_id;
     int m_last_command_id;
+    Priority m_priority;
+    int m_max_in_flight;
+    int m_in_flight;
     bool m_started;
     bool m_finished;
     bool m_wait_previous;
+    GDBTimings m_gdb_time;
+    int m_timed_commands;
 public:
     wxString m_Cmd; // FIXME: remove m_Cmd
 };
@@ -224,36 +315,138 @@ class CommandExecutor
 public:
     struct Result
     {
+        Result() : parser(NULL), count(1), received(0), parse_start(0), parse_end(0) {}
+
         dbg_mi::CommandID id;
-        wxString output;
+        std::string record; // the UTF-8 output line, the token is not stripped
+        RecordHeader header;
+        ResultParser *parser; // set if the record was parsed by the reader thread, it owns the record then
+        int count; // a burst of notifications of one class is queued as its first record and a count
+        int64_t received, parse_start, parse_end; // CommandStats::Now() stamps
+    };
+    // An output line classified by DecodeOutput, which can run on any thread.
+    struct OutputLine
+    {
+        OutputLine() : is_record(false), is_error(false) {}
+        ~OutputLine() { delete result.parser; }
+
+        wxString text; // for the log
+        Result result;
+        bool is_record;
+        bool is_error; // a record with one of the messages that abort the session
+    };
+    // When the commands released by the actions are written to GDB
+    enum WritePolicy
+    {
+        WriteEachCommand = 0,   // one write per command
+        WriteEachRun            // one write per ActionsMap::Run pass, see FlushCommands
     };
 public:
     CommandExecutor() :
         m_last(0),
-        m_logger(NULL)
+        m_logger(NULL),
+        m_in_flight_limit(0),
+        m_has_dispatched(false),
+        m_timings(false),
+        m_slow_command_us(0),
+        m_recorder(NULL),
+        m_write_policy(WriteEachRun),
+        m_max_batch(c_default_max_batch),
+        m_batch_count(0),
+        m_writes(0),
+        m_written_commands(0),
+        m_largest_write(0),
+        m_results_capacity(c_default_results_capacity),
+        m_results_high_water(0),
+        m_dropped_notifications(0)
     {
     }
-    virtual ~CommandExecutor() {}
+    virtual ~CommandExecutor()
+    {
+        for(Results::iterator it = m_results.begin(); it != m_results.end(); ++it)
+            delete it->parser;
+    }
 
     CommandID Execute(wxString const &cmd);
+    // With WriteEachRun the command is only buffered, FlushCommands writes it.
     void ExecuteSimple(dbg_mi::CommandID const &id, wxString const &cmd);
+    // Writes the buffered commands in one write.
+    void FlushCommands();
+
+    // The commands written whose result record hasn't arrived yet. ActionsMap::Run stops
+    // releasing commands when 'limit' are in flight, 0 is no limit.
+    void SetInFlightLimit(int limit) { m_in_flight_limit = limit; }
+    int GetInFlightLimit() const { return m_in_flight_limit; }
+    int GetInFlightCount() const { return m_in_flight.size(); }
+    bool CanSendCommand() const { return m_in_flight_limit <= 0 || GetInFlightCount() < m_in_flight_limit; }
+
+    // 'max_batch' commands are flushed even if the pass isn't over
+    void SetWritePolicy(WritePolicy policy, int max_batch = c_default_max_batch);
+    WritePolicy GetWritePolicy() const { return m_write_policy; }
+    unsigned long GetWriteCount() const { return m_writes; }
+    unsigned long GetWrittenCommandCount() const { return m_written_commands; }
+    int GetLargestWrite() const { return m_largest_write; }
+
+    // The results carry GDB's own timings after -enable-timings; the commands which
+    // took 'slow_command_ms' or more inside GDB are logged with their action's total.
+    void SetTimings(bool enabled, int slow_command_ms);
+    bool GetTimings() const { return m_timings; }
+
+    // DispatchResults stamps the action callback of the last result from GetResult
+    void StampCallback();
+    void StampCallbackEnd(Action const *action);
+    CommandStats& GetStats() { return m_stats; }
+
+    // The commands and the output lines are also written to 'recorder', NULL stops it
+    void SetRecorder(SessionRecorder *recorder) { m_recorder = recorder; }
 
     virtual wxString GetOutput() = 0;
 
     bool HasOutput() const { return !m_results.empty(); }
     bool ProcessOutput(wxString const &output);
+    // 'line' is a UTF-8 output line without the line end
+    bool ProcessOutput(char const *line, int length);
+    // Logs the line and queues its record, the parser of the record is taken over.
+    bool ProcessOutput(OutputLine &output);
+    // Only touches 'output', so it can be called on the reader thread.
+    // 'parse' parses the record too, GetResult then doesn't have to.
+    static void DecodeOutput(char const *line, int length, OutputLine &output, bool parse);
     Logger::Line::Type GetFilteredOutputError(wxString& output, Logger::Line::Type); //(ph 2024/04/24)
 
     void Clear();
 
+    // The notifications are dropped when this many results wait, the command results and
+    // the exec records (*stopped..) are always queued.
+    void SetResultsCapacity(size_t capacity) { m_results_capacity = capacity; }
+    size_t GetResultsHighWater() const { return m_results_high_water; }
+
     dbg_mi::ResultParser* GetResult(dbg_mi::CommandID &id)
+    {
+        int count;
+        return GetResult(id, count);
+    }
+    // 'count' is the number of notifications the result stands for
+    dbg_mi::ResultParser* GetResult(dbg_mi::CommandID &id, int &count)
     {
         assert(not m_results.empty());
-        Result const &r = m_results.front();
+        Result &r = m_results.front();
 
         id = r.id;
-        dbg_mi::ResultParser *parser = new dbg_mi::ResultParser;
-        if(not parser->Parse(r.output))
+        count = r.count;
+        dbg_mi::ResultParser *parser = r.parser;
+        bool parsed;
+        if(parser)
+        {
+            r.parser = NULL;
+            parsed = true;
+        }
+        else
+        {
+            r.parse_start = CommandStats::Now();
+            parsed = (parser = new dbg_mi::ResultParser)->Parse(r.record, r.header);
+            r.parse_end = CommandStats::Now();
+        }
+        if(not parsed)
         {
             // This causes GDB/MI to stall
             // On a malformed response, set m_type = TypeError
@@ -262,6 +455,9 @@ public:
             //-delete parser;
             //-parser = NULL;
         }
+        if(parser->GetResultType() == ResultParser::Result)
+            CommandDone(r, *parser);
+
         if (parser->GetParseError())
         {
             InfoWindow::Display(_("GDB/MI Parse Error"), wxString::Format(wxString::Format(_T("%s %s"),_("Malformed debug response for"), id.ToString().c_str()), 7000));
@@ -277,6 +473,8 @@ public:
         }
 
         m_results.pop_front();
+        if(m_results.empty() && m_dropped_notifications > 0)
+            ReportDroppedNotifications();
         return parser;
     }
 
@@ -286,13 +484,51 @@ public:
     int32_t GetLastID() const { return m_last; }
 protected:
     virtual bool DoExecute(dbg_mi::CommandID const &id, wxString const &cmd) = 0;
+    // 'commands' are 'count' command lines separated by line ends, the last one has none
+    virtual bool DoExecuteBatch(wxString const &commands, int count) = 0;
     virtual void DoClear() = 0;
+private:
+    void CountWrite(int count);
+    void CommandDone(Result const &r, ResultParser const &parser);
+    bool QueueResult(Result &r);
+    void ReportDroppedNotifications();
 
 protected:
     typedef std::deque<Result> Results;
     Results m_results;
     int32_t m_last;
     Logger *m_logger;
+private:
+    struct InFlightCommand
+    {
+        CommandID id;
+        wxString verb;
+        wxString command; // only kept with timings, for the slow command log
+        CommandStats::Stamps stamps;
+    };
+    typedef std::deque<InFlightCommand> InFlight;
+    InFlight m_in_flight;
+    int m_in_flight_limit;
+    InFlightCommand m_dispatched; // the command of the result being dispatched
+    bool m_has_dispatched;
+    CommandStats m_stats;
+    bool m_timings;
+    int64_t m_slow_command_us;
+    SessionRecorder *m_recorder;
+
+    static int const c_default_max_batch = 64;
+    WritePolicy m_write_policy;
+    int m_max_batch;
+    wxString m_batch;       // the commands waiting for FlushCommands
+    wxString m_batch_log;
+    int m_batch_count;
+    unsigned long m_writes, m_written_commands;
+    int m_largest_write;
+
+    static size_t const c_default_results_capacity = 4096;
+    size_t m_results_capacity;
+    size_t m_results_high_water;
+    int m_dropped_notifications;
 };
 
 // ----------------------------------------------------------------------------
@@ -311,11 +547,28 @@ public:
 
     bool Empty() const { return m_actions.empty(); }
     void Run(CommandExecutor &executor);
-    int GetCount(){return m_actions.size();} //(ph 2024/10/20)
+    int GetCount(){return m_count;} //(ph 2024/10/20)
 private:
-    typedef std::deque<Action*> Actions;
+    // the actions in the order they were added, it is the order of their ids
+    typedef std::list<Action*> Actions;
+    // Slot of an action id, the ids are consecutive so the slot of 'id' is
+    // m_slots[id - m_first_slot_id]. The slots of the removed actions at the front are
+    // recycled; a removed action in the middle leaves an empty slot until then.
+    struct Slot
+    {
+        Slot() : action(NULL) {}
+
+        Action *action;
+        Actions::iterator position;
+    };
+    typedef std::deque<Slot> Slots;
 
+    Actions::iterator Remove(Actions::iterator it);
+private:
     Actions m_actions;
+    Slots m_slots;
+    int m_first_slot_id;
+    int m_count;
     int m_last_id;
 };
 
@@ -327,7 +580,8 @@ bool DispatchResults(CommandExecutor &exec, ActionsMap &actions_map, OnNotify &o
     while(exec.HasOutput())
     {
         CommandID id;
-        ResultParser *parser = exec.GetResult(id);
+        int count;
+        ResultParser *parser = exec.GetResult(id, count);
 
         if(not parser)
             return false;
@@ -339,8 +593,15 @@ bool DispatchResults(CommandExecutor &exec, ActionsMap &actions_map, OnNotify &o
             case ResultParser::Result:
             {
                 Action *action = actions_map.Find(id.GetActionID());
+                exec.StampCallback();
                 if(action)
+                {
+                    action->CommandDone();
+                    if(parser->HasTimings())
+                        action->AddGDBTime(parser->GetTimings());
                     action->OnCommandOutput(id, *parser);
+                }
+                exec.StampCallbackEnd(action);
 
                 // show RunActionMsg
                 // class RunAction cannot use cbMessageBox, it's run under an external timer queue.
@@ -386,7 +647,7 @@ bool DispatchResults(CommandExecutor &exec, ActionsMap &actions_map, OnNotify &o
             case ResultParser::TypeUnknown:
                 break;
             default:
-                on_notify(*parser);
+                on_notify(*parser, count);
         }//endSwitch
 
         delete parser;
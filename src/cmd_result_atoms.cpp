@@ -0,0 +1,99 @@
+#include "cmd_result_atoms.h"
+
+#include <cstring>
+#include <stdint.h>
+
+namespace dbg_mi
+{
+
+namespace
+{
+
+char const * const c_atom_names[Atom_Count] =
+{
+    "",
+#define DBG_MI_ATOM_NAME(id, name) name,
+    DBG_MI_ATOMS(DBG_MI_ATOM_NAME)
+#undef DBG_MI_ATOM_NAME
+};
+
+// Open addressing, at most 25% full, so a lookup is almost always a single compare.
+int const c_table_size = 256;
+
+inline uint32_t HashName(char const *name, int length)
+{
+    uint32_t hash = 2166136261u; // FNV-1a
+    for(int ii = 0; ii < length; ++ii)
+    {
+        hash ^= static_cast<unsigned char>(name[ii]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+struct AtomTable
+{
+    AtomTable()
+    {
+        std::memset(slots, 0, sizeof(slots));
+        for(int atom = Atom_Unknown + 1; atom < Atom_Count; ++atom)
+        {
+            char const *name = c_atom_names[atom];
+            uint32_t slot = HashName(name, std::strlen(name)) & (c_table_size - 1);
+            while(slots[slot] != Atom_Unknown)
+                slot = (slot + 1) & (c_table_size - 1);
+            slots[slot] = static_cast<unsigned char>(atom);
+        }
+    }
+
+    unsigned char slots[c_table_size];
+};
+
+AtomTable const & GetAtomTable()
+{
+    static AtomTable const table;
+    return table;
+}
+
+} // anonymous namespace
+
+Atom FindAtom(char const *name, int length)
+{
+    AtomTable const &table = GetAtomTable();
+
+    uint32_t slot = HashName(name, length) & (c_table_size - 1);
+    while(table.slots[slot] != Atom_Unknown)
+    {
+        char const *atom_name = c_atom_names[table.slots[slot]];
+        if(static_cast<int>(std::strlen(atom_name)) == length && std::memcmp(atom_name, name, length) == 0)
+            return static_cast<Atom>(table.slots[slot]);
+        slot = (slot + 1) & (c_table_size - 1);
+    }
+    return Atom_Unknown;
+}
+
+char const * GetAtomName(Atom atom)
+{
+    return atom > Atom_Unknown && atom < Atom_Count ? c_atom_names[atom] : "";
+}
+
+KeyPath::KeyPath(char const *dotted)
+{
+    char const *start = dotted;
+    for(;;)
+    {
+        char const *end = std::strchr(start, '.');
+        int length = end ? end - start : std::strlen(start);
+
+        Key key;
+        key.name.assign(start, length);
+        key.atom = FindAtom(start, length);
+        m_keys.push_back(key);
+
+        if(not end)
+            break;
+        start = end + 1;
+    }
+}
+
+} // namespace dbg_mi
@@ -0,0 +1,113 @@
+#ifndef _Debugger_GDB_MI_CMD_RESULT_ATOMS_H_
+#define _Debugger_GDB_MI_CMD_RESULT_ATOMS_H_
+
+#include <string>
+#include <vector>
+
+namespace dbg_mi
+{
+
+// Field names of the GDB/MI records the plugin looks up.
+// Every name gets an Atom_xxx id ('-' is written as '_').
+#define DBG_MI_ATOMS(X) \
+    X(addr,                 "addr") \
+    X(address,              "address") \
+    X(args,                 "args") \
+    X(asm_insns,            "asm_insns") \
+    X(bkpt,                 "bkpt") \
+    X(bkptno,               "bkptno") \
+    X(changelist,           "changelist") \
+    X(child,                "child") \
+    X(children,             "children") \
+    X(contents,             "contents") \
+    X(core,                 "core") \
+    X(current_thread_id,    "current-thread-id") \
+    X(data,                 "data") \
+    X(displayhint,          "displayhint") \
+    X(disp,                 "disp") \
+    X(dynamic,              "dynamic") \
+    X(enabled,              "enabled") \
+    X(exit_code,            "exit-code") \
+    X(exp,                  "exp") \
+    X(file,                 "file") \
+    X(frame,                "frame") \
+    X(from,                 "from") \
+    X(fullname,             "fullname") \
+    X(func,                 "func") \
+    X(func_name,            "func-name") \
+    X(has_more,             "has_more") \
+    X(hw_awpt,              "hw-awpt") \
+    X(hw_rwpt,              "hw-rwpt") \
+    X(id,                   "id") \
+    X(in_scope,             "in_scope") \
+    X(inst,                 "inst") \
+    X(level,                "level") \
+    X(line,                 "line") \
+    X(line_asm_insn,        "line_asm_insn") \
+    X(memory,               "memory") \
+    X(msg,                  "msg") \
+    X(name,                 "name") \
+    X(new_num_children,     "new_num_children") \
+    X(new_thread_id,        "new-thread-id") \
+    X(new_type,             "new_type") \
+    X(number,               "number") \
+    X(numchild,             "numchild") \
+    X(offset,               "offset") \
+    X(original_location,    "original-location") \
+    X(pid,                  "pid") \
+    X(reason,               "reason") \
+    X(register_names,       "register-names") \
+    X(register_values,      "register-values") \
+    X(signal_meaning,       "signal-meaning") \
+    X(signal_name,          "signal-name") \
+    X(src_and_asm_line,     "src_and_asm_line") \
+    X(stack,                "stack") \
+    X(stack_args,           "stack-args") \
+    X(state,                "state") \
+    X(stopped_threads,      "stopped-threads") \
+    X(target_id,            "target-id") \
+    X(thread_groups,        "thread-groups") \
+    X(thread_id,            "thread-id") \
+    X(threads,              "threads") \
+    X(time,                 "time") \
+    X(times,                "times") \
+    X(type,                 "type") \
+    X(type_changed,         "type_changed") \
+    X(value,                "value") \
+    X(wpt,                  "wpt")
+
+enum Atom
+{
+    Atom_Unknown = 0, // not in the table, compare the names
+#define DBG_MI_ATOM_ENUM(id, name) Atom_##id,
+    DBG_MI_ATOMS(DBG_MI_ATOM_ENUM)
+#undef DBG_MI_ATOM_ENUM
+    Atom_Count
+};
+
+// Hash table lookup, returns Atom_Unknown for names not in the table.
+Atom FindAtom(char const *name, int length);
+char const * GetAtomName(Atom atom);
+
+// Dotted key like "bkpt.number", split and resolved to atoms once.
+// Keep it in a static to reuse it for every lookup.
+class KeyPath
+{
+public:
+    struct Key
+    {
+        Atom atom;
+        std::string name; // UTF-8, used when atom is Atom_Unknown
+    };
+public:
+    explicit KeyPath(char const *dotted);
+
+    int GetCount() const { return m_keys.size(); }
+    Key const & GetKey(int index) const { return m_keys[index]; }
+private:
+    std::vector<Key> m_keys;
+};
+
+} // namespace dbg_mi
+
+#endif // _Debugger_GDB_MI_CMD_RESULT_ATOMS_H_
@@ -1,44 +1,100 @@
 #include "cmd_result_parser.h"
 
+#include <cstring>
+#include <new>
+
 #include "cmd_result_tokens.h"
+#include "cmd_result_visitor.h"
+#include "escape.h"
+#include "structural_index.h"
 
 namespace dbg_mi
 {
 
-void find_and_replace(wxString &source, const wxString &find, wxString const &replace)
+// The tokenizer only starts a string at the beginning of a token,
+// a quote in the middle of an unquoted value is an ordinary char.
+static bool IsStringStart(char const *buffer, int pos)
 {
-    for (size_t j; (j = source.find(find)) != wxString::npos; )
-    {
-        source.replace(j, find.length(), replace);
-    }
+    while(pos > 0 && (buffer[pos - 1] == ' ' || buffer[pos - 1] == '\t'))
+        --pos;
+    if(pos == 0)
+        return true;
+    char c = buffer[pos - 1];
+    return c == '{' || c == '[' || c == ',' || c == '=' || c == '}' || c == ']';
 }
-bool StripEnclosingQuotes(wxString &str)
+
+// Moves 'pos' (just after an opening bracket) past the matching closing bracket.
+static bool SkipValue(char const *buffer, int length, int &pos, char closing, StructuralIndex const *index)
 {
-    if(str.length() == 0)
-        return true;
-    if(str[0] == _T('"') && str[str.length() - 1] == _T('"'))
+    int depth = 1;
+    if(index)
     {
-        if(str.length() >= 2 && str[str.length() - 2] == _T('\\'))
-            return false;
-        str = str.substr(1, str.length() - 2);
-    }
-    else if(str[0] == _T('"'))
+        for(int p = index->FindNext(pos); p != -1; p = index->FindNext(p + 1))
+        {
+            switch(buffer[p])
+            {
+            case '{':
+            case '[':
+                ++depth;
+                break;
+            case '}':
+            case ']':
+                if(--depth == 0)
+                {
+                    pos = p + 1;
+                    return buffer[p] == closing;
+                }
+                break;
+            case '"':
+                // the index doesn't know about quotes inside unquoted values
+                if(not IsStringStart(buffer, p))
+                    return false;
+                // the next bit is the closing quote
+                p = index->FindNext(p + 1);
+                if(p == -1)
+                    return false;
+                break;
+            default:
+                break;
+            }
+        }
         return false;
-    else if(str[str.length() - 1] == _T('"'))
-    {
-        if(str.length() >= 2 && str[str.length() - 2] != _T('\\'))
-            return false;
     }
 
-    find_and_replace(str, _T("\\\""), _T("\""));
-    return true;
+    bool in_quote = false;
+    for(int p = pos; p < length; ++p)
+    {
+        char c = buffer[p];
+        if(in_quote)
+        {
+            if(c == '\\')
+                ++p;
+            else if(c == '"')
+                in_quote = false;
+        }
+        else if(c == '"')
+            in_quote = IsStringStart(buffer, p);
+        else if(c == '{' || c == '[')
+            ++depth;
+        else if((c == '}' || c == ']') && --depth == 0)
+        {
+            pos = p + 1;
+            return c == closing;
+        }
+    }
+    return false;
 }
 
-bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_closing_brace)
+// 'index' is optional, without it the tokens are found by scanning the characters.
+// If 'lazy' is set the nested tuples/lists are only skipped and decoded on demand.
+bool ParseTuple(char const *buffer, int length, int &start, ResultValue &tuple, bool want_closing_brace,
+                StructuralIndex const *index, bool lazy)
 {
     Token token;
     int pos = start;
     ResultValue *curr_value = NULL;
+    ResultArena *arena = tuple.GetArena();
+    Span name;
 
     enum Step
     {
@@ -49,10 +105,15 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
     };
     Step step = Nothing;
 
-    while(pos < static_cast<int>(str.length()))
+    while(pos < length)
     {
-        if(not GetNextToken(str, pos, token))
+        bool has_token = index ? index->GetNextToken(buffer, length, pos, token)
+                               : GetNextToken(buffer, length, pos, token);
+        if(not has_token)
+        {
+            ResultValue::Destroy(curr_value, arena);
             return false;
+        }
 
         switch(token.type)
         {
@@ -61,15 +122,21 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
             if(curr_value)
             {
                 if(step != Equal)
+                {
+                    ResultValue::Destroy(curr_value, arena);
                     return false;
+                }
                 step = Value;
 
                 curr_value->SetType(ResultValue::Simple);
-                wxString value = token.ExtractString(str);
+                Span value = token.GetSpan(buffer);
 
                 if(not StripEnclosingQuotes(value))
+                {
+                    ResultValue::Destroy(curr_value, arena);
                     return false;
-                curr_value->SetSimpleValue(value);
+                }
+                curr_value->SetSimpleValue(value, true);
             }
             else
             {
@@ -77,8 +144,9 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
                     return false;
                 step = Name;
 
-                curr_value = new ResultValue;
-                curr_value->SetName(token.ExtractString(str));
+                curr_value = ResultValue::Create(arena);
+                name = token.GetSpan(buffer);
+                curr_value->SetName(name);
             }
             break;
 
@@ -87,7 +155,7 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
                 return false;
             if(step != Name)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
             step = Equal;
@@ -100,13 +168,14 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
             {
                 if(step == Name)
                 {
+                    // array item without a name, the value is kept with the quotes
                     curr_value->SetType(ResultValue::Simple);
-                    curr_value->SetSimpleValue(curr_value->GetName());
-                    curr_value->SetName(_T(""));
+                    curr_value->SetSimpleValue(name, false);
+                    curr_value->SetName(Span());
                 }
                 else if(step != Value)
                 {
-                    delete curr_value;
+                    ResultValue::Destroy(curr_value, arena);
                     return false;
                 }
             }
@@ -114,7 +183,7 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
             {
                 if(step != Value)
                 {
-                    delete curr_value;
+                    ResultValue::Destroy(curr_value, arena);
                     return false;
                 }
             }
@@ -130,21 +199,33 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
                     return false;
                 else
                 {
-                    curr_value = new ResultValue;
+                    curr_value = ResultValue::Create(arena);
                     step = Equal;
                 }
             }
             if(step != Equal)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
 
             curr_value->SetType(ResultValue::Tuple);
             pos = token.end;
-            if(not ParseTuple(str, pos, *curr_value, true))
+            if(lazy)
+            {
+                if(not SkipValue(buffer, length, pos, '}', index))
+                {
+                    ResultValue::Destroy(curr_value, arena);
+                    return false;
+                }
+                curr_value->SetPending(token.end);
+                token.end = pos;
+                token.type = Token::TupleEnd;
+                step = Value;
+            }
+            else if(not ParseTuple(buffer, length, pos, *curr_value, true, index, false))
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
             else
@@ -160,14 +241,26 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
                 return false;
             if(step != Equal)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
             curr_value->SetType(ResultValue::Array);
             pos = token.end;
-            if(not ParseTuple(str, pos, *curr_value, true))
+            if(lazy)
+            {
+                if(not SkipValue(buffer, length, pos, ']', index))
+                {
+                    ResultValue::Destroy(curr_value, arena);
+                    return false;
+                }
+                curr_value->SetPending(token.end);
+                token.end = pos;
+                token.type = Token::ListEnd;
+                step = Value;
+            }
+            else if(not ParseTuple(buffer, length, pos, *curr_value, true, index, false))
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
             else
@@ -183,32 +276,30 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
                 return false;
             if(tuple.GetType() != ResultValue::Tuple || !want_closing_brace)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
             if(step != Value)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
-            start = pos + 1;
+            start = token.end;
             tuple.SetTupleValue(curr_value);
             return true;
 
         case Token::ListEnd:
-//            if(not curr_value)
-//                return false;
             if(tuple.GetType() != ResultValue::Array || !want_closing_brace)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
 
             if(step == Name)
             {
                 curr_value->SetType(ResultValue::Simple);
-                curr_value->SetSimpleValue(curr_value->GetName());
-                curr_value->SetName(_T(""));
+                curr_value->SetSimpleValue(name, false);
+                curr_value->SetName(Span());
                 tuple.SetTupleValue(curr_value);
             }
             else if(step == Value)
@@ -217,11 +308,11 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
             }
             else if(step != Nothing || curr_value)
             {
-                delete curr_value;
+                ResultValue::Destroy(curr_value, arena);
                 return false;
             }
 
-            start = pos + 1;
+            start = token.end;
             return true;
         default:
             assert(false);
@@ -234,7 +325,7 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
     {
         if(step != Value)
         {
-            delete curr_value;
+            ResultValue::Destroy(curr_value, arena);
             return false;
         }
         else
@@ -251,11 +342,149 @@ bool ParseTuple(wxString const &str, int &start, ResultValue &tuple, bool want_c
     return true;
 }
 
+bool ParseValue(char const *buffer, int length, ResultValue &results, int start)
+{
+    results.SetType(ResultValue::Tuple);
+
+    // values in an arena that knows the record can be decoded lazily
+    ResultArena *arena = results.GetArena();
+    if(arena && arena->GetRecord() != buffer)
+        arena = NULL;
+    bool lazy = arena && arena->IsLazy();
+
+    if(length - start >= c_structural_index_min_length)
+    {
+        StructuralIndex local_index;
+        StructuralIndex const *index = &local_index;
+        if(arena)
+            index = &arena->BuildIndex();
+        else
+            local_index.Build(buffer, length);
+
+        int pos = start;
+        if(ParseTuple(buffer, length, pos, results, false, index, lazy))
+            return true;
+
+        // The index can't describe some malformed records (e.g. a quote inside an
+        // unquoted value), so let the scalar tokenizer have the final word.
+        if(arena)
+            arena->DropIndex();
+        results.Clear();
+        results.SetType(ResultValue::Tuple);
+    }
+    return ParseTuple(buffer, length, start, results, false, NULL, lazy);
+}
 
 bool ParseValue(wxString const &str, ResultValue &results, int start)
 {
-    results.SetType(ResultValue::Tuple);
-    return ParseTuple(str, start, results, false);
+    wxScopedCharBuffer utf8 = str.substr(start).utf8_str();
+    bool result = ParseValue(utf8.data(), utf8.length(), results, 0);
+    // the spans point into the temporary buffer
+    results.Materialize();
+    return result;
+}
+
+namespace
+{
+size_t const c_arena_block_size = 32 * 1024;
+size_t const c_arena_alignment = 16;
+}
+
+void* ResultArena::Allocate(size_t size)
+{
+    size = (size + c_arena_alignment - 1) & ~(c_arena_alignment - 1);
+    if(size > m_left)
+    {
+        // big requests (large child arrays) get a block of their own
+        size_t block_size = std::max(size, c_arena_block_size);
+        char *block = static_cast<char*>(::operator new(block_size));
+        m_blocks.push_back(block);
+        if(block_size == size)
+            return block;
+        m_current = block;
+        m_left = block_size;
+    }
+    void *result = m_current;
+    m_current += size;
+    m_left -= size;
+    return result;
+}
+
+void ResultArena::Release()
+{
+    for(std::vector<char*>::iterator it = m_blocks.begin(); it != m_blocks.end(); ++it)
+        ::operator delete(*it);
+    m_blocks.clear();
+    m_current = NULL;
+    m_left = 0;
+}
+
+ResultValue* ResultValue::Create(ResultArena *arena)
+{
+    if(arena)
+        return new (arena->Allocate(sizeof(ResultValue))) ResultValue(arena);
+    else
+        return new ResultValue;
+}
+
+void ResultValue::Destroy(ResultValue *value, ResultArena *arena)
+{
+    if(not value)
+        return;
+    // the memory of arena values is released with the arena
+    if(arena)
+        value->~ResultValue();
+    else
+        delete value;
+}
+
+void ResultValue::SetName(wxString const &name)
+{
+    m_name = name;
+    m_raw_name = Span();
+    wxScopedCharBuffer utf8 = name.utf8_str();
+    m_atom = FindAtom(utf8.data(), utf8.length());
+}
+
+void ResultValue::DecodePending() const
+{
+    ResultArena *arena = GetArena();
+    assert(arena && arena->GetRecord());
+
+    int start = m_pending_start;
+    m_pending_start = -1;
+
+    // decoding doesn't change the observable value, only fills the children
+    ResultValue &self = const_cast<ResultValue&>(*this);
+    char const *record = arena->GetRecord();
+    int length = arena->GetRecordLength();
+    StructuralIndex const *index = arena->GetIndex();
+
+    int pos = start;
+    if(ParseTuple(record, length, pos, self, true, index, true))
+        return;
+    if(index)
+    {
+        // same fallback as in ParseValue
+        self.m_value.Clear();
+        pos = start;
+        if(ParseTuple(record, length, pos, self, true, NULL, true))
+            return;
+    }
+    // Malformed subtree, the brackets matched when the record was parsed.
+    // Keep what could be decoded and report it like the eager parser does.
+    arena->SetDecodeError();
+}
+
+void ResultValue::Clear()
+{
+    m_pending_start = -1;
+    m_name.clear();
+    m_atom = Atom_Unknown;
+    m_raw_name = Span();
+    m_raw_simple = Span();
+    m_unescape = false;
+    m_value.Clear();
 }
 
 void ResultValue::SetType(Type type)
@@ -263,6 +492,97 @@ void ResultValue::SetType(Type type)
     m_type = type;
 }
 
+void ResultValue::SetSimpleValue(Span const &value, bool unescape)
+{
+    assert(m_type == Simple);
+    m_value.simple.clear();
+    m_raw_simple = value;
+    m_unescape = unescape;
+}
+
+void ResultValue::ConvertSimpleValue() const
+{
+    if(m_unescape && std::memchr(m_raw_simple.data, '\\', m_raw_simple.length))
+    {
+        std::string decoded(m_raw_simple.data, m_raw_simple.length);
+        int length = UnescapeCString(decoded.data(), decoded.length(), &decoded[0]);
+        m_value.simple = wxString::FromUTF8(decoded.data(), length);
+        // octal escapes of a non UTF-8 charset
+        if(m_value.simple.empty() && length > 0)
+            m_value.simple = wxString(decoded.data(), wxConvISO8859_1, length);
+    }
+    else
+        m_value.simple = m_raw_simple.ToString();
+    m_raw_simple = Span();
+}
+
+bool ResultValue::NameEquals(char const *name, int length) const
+{
+    if(not m_raw_name.IsNull())
+        return m_raw_name == Span(name, length);
+
+    wxScopedCharBuffer utf8 = m_name.utf8_str();
+    return Span(utf8.data(), utf8.length()) == Span(name, length);
+}
+
+void ResultValue::Materialize()
+{
+    Decode();
+    GetName();
+    if(m_type == Simple)
+        GetSimpleValue();
+    else
+    {
+        for(Container::iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
+            (*it)->Materialize();
+    }
+}
+
+bool ResultValue::CanVisit() const
+{
+    if(IsPending() || (m_raw_name.IsNull() && not m_name.empty()))
+        return false;
+    if(m_type == Simple)
+        return not m_raw_simple.IsNull();
+    for(Container::const_iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
+    {
+        if(not (*it)->CanVisit())
+            return false;
+    }
+    return true;
+}
+
+bool ResultValue::VisitChildren(ResultVisitor &visitor) const
+{
+    for(Container::const_iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
+    {
+        ResultValue const &child = **it;
+        Span name = child.m_raw_name;
+        switch(child.m_type)
+        {
+        case Simple:
+            {
+                // the visitor gets the string tokens with their quotes, they are around the span
+                Span value = child.m_raw_simple;
+                if(child.m_unescape && value.data[-1] == '"')
+                    value = Span(value.data - 1, value.length + 2);
+                if(not visitor.OnValue(name, value))
+                    return false;
+            }
+            break;
+        case Tuple:
+            if(not visitor.OnTupleStart(name) || not child.VisitChildren(visitor) || not visitor.OnTupleEnd())
+                return false;
+            break;
+        case Array:
+            if(not visitor.OnListStart(name) || not child.VisitChildren(visitor) || not visitor.OnListEnd())
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+
 void ResultValue::SetTupleValue(ResultValue *value)
 {
     assert(value);
@@ -272,51 +592,75 @@ void ResultValue::SetTupleValue(ResultValue *value)
 ResultValue const * ResultValue::GetTupleValue(wxString const &key) const
 {
     assert(m_type == Tuple);
-    wxString::size_type pos = key.find(_T('.'));
-    if(pos != wxString::npos)
+    // compare the names as UTF-8, so the spans don't need to be converted
+    wxScopedCharBuffer utf8 = key.utf8_str();
+    char const *name = utf8.data();
+    int length = utf8.length();
+
+    ResultValue const *value = this;
+    char const *dot;
+    while((dot = static_cast<char const*>(std::memchr(name, '.', length))) != NULL)
     {
-        wxString const &subkey = key.substr(0, pos);
-        Container::const_iterator it = FindTupleValue(subkey);
-        if(it != m_value.tuple.end() && (*it)->GetType() == Tuple)
-            return (*it)->GetTupleValue(key.substr(pos + 1, key.length() - pos - 1));
+        int sub_length = dot - name;
+        value = value->FindTupleValue(FindAtom(name, sub_length), name, sub_length);
+        if(not value || value->GetType() != Tuple)
+            return NULL;
+        length -= sub_length + 1;
+        name = dot + 1;
     }
-    else
+    return value->FindTupleValue(FindAtom(name, length), name, length);
+}
+
+ResultValue const * ResultValue::GetTupleValue(Atom key) const
+{
+    assert(m_type == Tuple);
+    assert(key != Atom_Unknown);
+    return FindTupleValue(key, NULL, 0);
+}
+
+ResultValue const * ResultValue::GetTupleValue(KeyPath const &key) const
+{
+    assert(m_type == Tuple);
+    ResultValue const *value = this;
+    for(int ii = 0; ii < key.GetCount(); ++ii)
     {
-        Container::const_iterator it = FindTupleValue(key);
-        if(it != m_value.tuple.end())
-            return *it;
+        if(ii > 0 && value->GetType() != Tuple)
+            return NULL;
+        KeyPath::Key const &k = key.GetKey(ii);
+        value = value->FindTupleValue(k.atom, k.name.data(), k.name.length());
+        if(not value)
+            return NULL;
     }
-    return NULL;
+    return value;
 }
 
 ResultValue const* ResultValue::GetTupleValueByIndex(int index) const
 {
-    Container::const_iterator it = m_value.tuple.begin();
-
-    std::advance(it, index);
-    if(it != m_value.tuple.end())
-        return *it;
+    Decode();
+    if(index >= 0 && index < static_cast<int>(m_value.tuple.size()))
+        return m_value.tuple[index];
     else
         return NULL;
 }
 
 wxString ResultValue::MakeDebugString() const
 {
+    Decode();
     switch(m_type)
     {
     case Simple:
-        if(m_name.empty())
-            return m_value.simple;
+        if(GetName().empty())
+            return GetSimpleValue();
         else
-            return m_name + _T("=") + m_value.simple;
+            return GetName() + _T("=") + GetSimpleValue();
         break;
     case Tuple:
         {
             wxString s;
-            if(m_name.empty())
+            if(GetName().empty())
                 s = _T("{");
             else
-                s = m_name + _T("={");
+                s = GetName() + _T("={");
 
             bool first = true;
             for(Container::const_iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
@@ -335,10 +679,10 @@ wxString ResultValue::MakeDebugString() const
     case Array:
         {
             wxString s;
-            if(m_name.empty())
+            if(GetName().empty())
                 s = _T("[");
             else
-                s = m_name + _T("=[");
+                s = GetName() + _T("=[");
             bool first = true;
             for(Container::const_iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
             {
@@ -360,70 +704,222 @@ wxString ResultValue::MakeDebugString() const
 
 bool ResultParser::Parse(wxString const &s)
 {
-    m_type = ParseType(s);
-    m_class = ClassUnknown;
-    m_parseError = false;
-    wxString str = s.substr(1, s.length() - 1);
-    if (str.length() == 0)
+    wxScopedCharBuffer utf8 = s.utf8_str();
+    std::string buffer(utf8.data(), utf8.length());
+    return Parse(buffer);
+}
+
+// Fills the type and the class of the record starting at header.prefix_pos.
+static void DecodeRecordClass(char const *line, int length, RecordHeader &header)
+{
+    int pos = header.prefix_pos;
+    header.prefix = pos < length ? line[pos] : 0;
+    header.type = ResultParser::ParseType(header.prefix);
+    header.result_class = ResultParser::ClassUnknown;
+    header.class_end = pos + 1;
+    if(pos + 1 >= length)
+        return;
+
+    Span str(line + pos + 1, length - pos - 1);
+    if(header.type == ResultParser::NotifyAsyncOutput)
+    {
+        char const *comma = static_cast<char const*>(std::memchr(str.data, ',', str.length));
+        header.class_end = comma ? comma - line : length;
+        return;
+    }
+
+    struct ClassName
+    {
+        char const *name;
+        int length;
+        ResultParser::Class result_class;
+    };
+    static ClassName const done = { "done", 4, ResultParser::ClassDone };
+    static ClassName const stopped = { "stopped", 7, ResultParser::ClassStopped };
+    static ClassName const running = { "running", 7, ResultParser::ClassRunning };
+    static ClassName const connected = { "connected", 9, ResultParser::ClassConnected };
+    static ClassName const error = { "error", 5, ResultParser::ClassError };
+    static ClassName const exit = { "exit", 4, ResultParser::ClassExit };
+
+    // the first char selects the candidate, so each class is compared once at most
+    ClassName const *name;
+    switch(str.data[0])
+    {
+    case 'd': name = &done; break;
+    case 's': name = &stopped; break;
+    case 'r': name = &running; break;
+    case 'c': name = &connected; break;
+    case 'e': name = str.length > 1 && str.data[1] == 'x' ? &exit : &error; break;
+    default:
+        return;
+    }
+    if(name->length <= str.length && std::memcmp(str.data, name->name, name->length) == 0)
+    {
+        header.result_class = name->result_class;
+        header.class_end = pos + 1 + name->length;
+    }
+}
+
+bool DecodeRecordHeader(char const *line, int length, RecordHeader &header)
+{
+    header = RecordHeader();
+    if(length <= 0)
         return false;
 
-    wxString::size_type after_class_index = 0;
+    int pos = 0;
+    while(pos < length && line[pos] >= '0' && line[pos] <= '9')
+        ++pos;
 
-    if (m_type == NotifyAsyncOutput)
+    if(pos == 0)
     {
-        after_class_index = str.find(_T(','));
-        if (after_class_index == wxString::npos)
+        switch(line[0])
         {
-            m_async_type = str;
-            return true;
+        case '*':
+        case '^':
+        case '+':
+        case '=':
+            break;
+        default:
+            return false;
         }
-        else
-            m_async_type = str.substr(0, after_class_index);
     }
+    else if(pos <= 10)
+        return false;
     else
     {
-        if(str.StartsWith(_T("done")))
-        {
-            m_class = ClassDone;
-            after_class_index = 4;
-        }
-        else if(str.StartsWith(_T("stopped")))
-        {
-            m_class = ClassStopped;
-            after_class_index = 7;
-        }
-        else if(str.StartsWith(_T("running")))
-        {
-            m_class = ClassRunning;
-            after_class_index = 7;
-        }
-        else if(str.StartsWith(_T("connected")))
-        {
-            m_class = ClassConnected;
-            after_class_index = 9;
-        }
-        else if(str.StartsWith(_T("error")))
+        int64_t action = 0, command = 0;
+        for(int ii = 0; ii < pos - 10; ++ii)
+            action = action * 10 + (line[ii] - '0');
+        for(int ii = pos - 10; ii < pos; ++ii)
+            command = command * 10 + (line[ii] - '0');
+        header.has_token = true;
+        header.action = static_cast<int32_t>(action);
+        header.command = static_cast<int32_t>(command);
+    }
+
+    header.prefix_pos = pos;
+    DecodeRecordClass(line, length, header);
+    return true;
+}
+
+bool ResultParser::Parse(std::string &utf8)
+{
+    RecordHeader header;
+    DecodeRecordClass(utf8.data(), utf8.length(), header);
+    return Parse(utf8, header);
+}
+
+// Reads a decimal number of seconds ("0.00345") as microseconds, it doesn't depend on the locale.
+static bool DecodeSeconds(char const *line, int length, int &pos, int64_t &microseconds)
+{
+    int64_t seconds = 0, fraction = 0, scale = 1000000;
+    int start = pos;
+    for(; pos < length && line[pos] >= '0' && line[pos] <= '9'; ++pos)
+        seconds = seconds * 10 + (line[pos] - '0');
+    if(pos < length && line[pos] == '.')
+    {
+        for(++pos; pos < length && line[pos] >= '0' && line[pos] <= '9'; ++pos)
         {
-            m_class = ClassError;
-            after_class_index = 5;
+            if(scale > 1)
+            {
+                scale /= 10;
+                fraction += (line[pos] - '0') * scale;
+            }
         }
-        else if(str.StartsWith(_T("exit")))
+    }
+    microseconds = seconds * 1000000 + fraction;
+    return pos > start;
+}
+
+// Finds the trailing ,time={wallclock="..",user="..",system=".."} of a result record.
+// Returns its position or -1.
+static int DecodeTimings(std::string const &record, int class_end, GDBTimings &timings)
+{
+    static char const prefix[] = ",time={";
+    int const prefix_length = sizeof(prefix) - 1;
+    if(record.empty() || record[record.length() - 1] != '}')
+        return -1;
+    std::string::size_type found = record.rfind(prefix);
+    if(found == std::string::npos || static_cast<int>(found) < class_end)
+        return -1;
+
+    struct Field
+    {
+        char const *name;
+        int length;
+        int64_t *value;
+    };
+    Field const fields[] = {
+        { "wallclock=\"", 11, &timings.wallclock },
+        { "user=\"", 6, &timings.user },
+        { "system=\"", 8, &timings.system }
+    };
+
+    char const *line = record.data();
+    int length = record.length();
+    int pos = found + prefix_length;
+    for(int ii = 0; ii < 3; ++ii)
+    {
+        Field const &field = fields[ii];
+        if(ii > 0 && (pos >= length || line[pos++] != ','))
+            return -1;
+        if(pos + field.length > length || std::memcmp(line + pos, field.name, field.length) != 0)
+            return -1;
+        pos += field.length;
+        if(not DecodeSeconds(line, length, pos, *field.value) || pos >= length || line[pos++] != '"')
+            return -1;
+    }
+    if(pos != length - 1)
+        return -1;
+    return found;
+}
+
+bool ResultParser::Parse(std::string &line, RecordHeader const &header)
+{
+    m_value.Clear(); // the old values point into m_buffer
+    m_buffer.swap(line);
+    line.clear();
+    m_arena.SetRecord(NULL, 0, false);
+
+    m_type = header.type;
+    m_class = header.result_class;
+    m_value_start = -1;
+    m_parseError = false;
+    m_timings = GDBTimings();
+    m_has_timings = false;
+
+    if(m_type == Result)
+    {
+        int timings = DecodeTimings(m_buffer, header.class_end, m_timings);
+        if(timings >= 0)
         {
-            m_class = ClassExit;
-            after_class_index = 4;
+            m_buffer.resize(timings);
+            m_has_timings = true;
         }
-        else
-            return false;
     }
 
-    if(str[after_class_index] == _T(','))
-    {   //-return ParseValue(str, m_value, after_class_index + 1);
+    char const *record = m_buffer.data();
+    int length = m_buffer.length();
+    if (length - header.prefix_pos < 2)
+        return false;
+
+    if (m_type == NotifyAsyncOutput)
+        m_async_type = Span(record + header.prefix_pos + 1, header.class_end - header.prefix_pos - 1).ToString();
+    else if (m_class == ClassUnknown)
+        return false;
+
+    // the results are parsed in place, the header is not copied off the line
+    int pos = header.class_end;
+    if(pos < length && record[pos] == ',')
+    {
+        m_value_start = pos + 1;
+        m_arena.SetRecord(record, length, m_lazy);   //-return ParseValue(str, m_value, after_class_index + 1);
         // Avoid MI stall if false is passed back
-        if (not ParseValue(str, m_value, after_class_index + 1))
+        if (not ParseValue(record, length, m_value, m_value_start))
             m_parseError = true;                                    // malformed response
         return true;
     }
-    else if(after_class_index != str.length())
+    else if(pos != length)
     {   //-return false;        // avoid MI stall
         m_parseError = true;    // on malformed responses
         return true;
@@ -432,22 +928,37 @@ bool ResultParser::Parse(wxString const &s)
         return true;
 }
 
+bool ResultParser::Visit(ResultVisitor &visitor) const
+{
+    if(m_value_start < 0)
+        return false;
+    // the tree of an eager parse (e.g. on the reader thread) saves tokenizing the record again
+    if(not m_parseError && m_value.CanVisit())
+        return m_value.VisitChildren(visitor);
+    return VisitValue(m_buffer.data(), m_buffer.length(), visitor, m_value_start);
+}
+
 ResultParser::Type ResultParser::ParseType(wxString const &str)
 {
     if(str.empty())
         return TypeUnknown;
 
-    switch(static_cast<int>(str[0]))
+    return ParseType(static_cast<char>(str[0].GetValue()));
+}
+
+ResultParser::Type ResultParser::ParseType(char first_char)
+{
+    switch(first_char)
     {
-    case _T('^'): // result record
+    case '^': // result record
         return ResultParser::Result;
-    case _T('*'):
+    case '*':
         return ResultParser::ExecAsyncOutput;
 
-    case _T('+'):
+    case '+':
         return ResultParser::StatusAsyncOutput;
 
-    case _T('='):
+    case '=':
         return ResultParser::NotifyAsyncOutput;
     default:
         return TypeUnknown;
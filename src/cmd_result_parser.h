@@ -2,12 +2,115 @@
 #define _DEBUGGER_MI_CMD_RESULT_PARSER_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <type_traits>
 #include <vector>
+#include <string>
 #include <wx/string.h>
 
+#include "cmd_result_atoms.h"
+#include "cmd_result_tokens.h"
+#include "structural_index.h"
+
 namespace dbg_mi
 {
 
+class ResultVisitor;
+
+// Bump allocator for the nodes of a parsed record. Nothing is freed
+// individually, all blocks are released at once with the owner.
+// It also knows the record, so lazy values can be decoded later.
+class ResultArena
+{
+public:
+    ResultArena() :
+        m_current(NULL),
+        m_left(0),
+        m_record(NULL),
+        m_record_length(0),
+        m_lazy(false),
+        m_has_index(false),
+        m_decode_error(false)
+    {
+    }
+    ~ResultArena() { Release(); }
+
+    void* Allocate(size_t size);
+    void Release();
+
+    // The record must stay valid as long as values are allocated in the arena.
+    void SetRecord(char const *buffer, int length, bool lazy)
+    {
+        m_record = buffer;
+        m_record_length = length;
+        m_lazy = lazy;
+        m_has_index = false;
+        m_decode_error = false;
+    }
+    char const * GetRecord() const { return m_record; }
+    int GetRecordLength() const { return m_record_length; }
+    bool IsLazy() const { return m_lazy; }
+    // A lazy value of the record was malformed when it was decoded
+    void SetDecodeError() { m_decode_error = true; }
+    bool HasDecodeError() const { return m_decode_error; }
+
+    StructuralIndex& BuildIndex()
+    {
+        m_index.Build(m_record, m_record_length);
+        m_has_index = true;
+        return m_index;
+    }
+    void DropIndex() { m_has_index = false; }
+    StructuralIndex const * GetIndex() const { return m_has_index ? &m_index : NULL; }
+private:
+    ResultArena(ResultArena const &);
+    ResultArena& operator =(ResultArena const &);
+private:
+    std::vector<char*> m_blocks;
+    char *m_current;
+    size_t m_left;
+
+    char const *m_record;
+    int m_record_length;
+    bool m_lazy;
+    StructuralIndex m_index;
+    bool m_has_index;
+    bool m_decode_error;
+};
+
+// Allocates from the arena, or from the heap if there is none (copies of the values).
+template<typename T>
+struct ArenaAllocator
+{
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator(ResultArena *arena_ = NULL) : arena(arena_) {}
+    template<typename U>
+    ArenaAllocator(ArenaAllocator<U> const &o) : arena(o.arena) {}
+
+    T* allocate(size_t n)
+    {
+        if(arena)
+            return static_cast<T*>(arena->Allocate(n * sizeof(T)));
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    void deallocate(T *p, size_t)
+    {
+        if(not arena)
+            ::operator delete(p);
+    }
+
+    template<typename U>
+    bool operator ==(ArenaAllocator<U> const &o) const { return arena == o.arena; }
+    template<typename U>
+    bool operator !=(ArenaAllocator<U> const &o) const { return arena != o.arena; }
+
+    ResultArena *arena;
+};
+
 class ResultValue
 {
     struct Equal
@@ -18,7 +121,7 @@ class ResultValue
         }
     };
 public:
-    typedef std::vector<ResultValue*> Container;
+    typedef std::vector<ResultValue*, ArenaAllocator<ResultValue*> > Container;
     enum Type
     {
         Simple = 0,
@@ -27,26 +130,67 @@ public:
     };
 public:
     ResultValue() :
-        m_type(Simple)
+        m_atom(Atom_Unknown),
+        m_type(Simple),
+        m_unescape(false),
+        m_pending_start(-1)
+    {
+    }
+    // The children of this value will be allocated in 'arena'
+    explicit ResultValue(ResultArena *arena) :
+        m_atom(Atom_Unknown),
+        m_type(Simple),
+        m_unescape(false),
+        m_pending_start(-1),
+        m_value(arena)
     {
     }
     ResultValue(wxChar const *name, Type type) :
-        m_name(name),
-        m_type(type)
+        m_type(type),
+        m_unescape(false),
+        m_pending_start(-1)
+    {
+        SetName(name);
+    }
+    // Copies never point into the record buffer of the original
+    ResultValue(ResultValue const &o) :
+        m_name(o.GetName()),
+        m_atom(o.m_atom),
+        m_type(o.m_type),
+        m_unescape(false),
+        m_pending_start(-1),
+        m_value(o.Decoded().m_value)
+    {
+        if(m_type == Simple)
+            m_value.simple = o.GetSimpleValue();
+    }
+    ResultValue& operator =(ResultValue o)
     {
+        m_name.swap(o.m_name);
+        m_atom = o.m_atom;
+        m_raw_name = Span();
+        m_raw_simple = Span();
+        m_unescape = false;
+        m_pending_start = -1;
+        m_type = o.m_type;
+        swap(m_value, o.m_value);
+        return *this;
     }
 
     bool operator ==(ResultValue const &o) const
     {
-        if(m_name == o.m_name && m_type == o.m_type)
+        Decode();
+        o.Decode();
+        if(GetName() == o.GetName() && m_type == o.m_type)
         {
             switch(m_type)
             {
             case Simple:
-                return m_value.simple == o.m_value.simple;
+                return GetSimpleValue() == o.GetSimpleValue();
             case Array:
             case Tuple:
-                return std::equal(m_value.tuple.begin(), m_value.tuple.end(), o.m_value.tuple.begin(), Equal());
+                return m_value.tuple.size() == o.m_value.tuple.size()
+                    && std::equal(m_value.tuple.begin(), m_value.tuple.end(), o.m_value.tuple.begin(), Equal());
                 break;
             }
         }
@@ -56,43 +200,103 @@ public:
 
 public:
 
-    void SetName(wxString const &name) { m_name = name; }
-    void SetSimpleValue(wxString const &value) { assert(m_type == Simple); m_value.simple = value; }
+    void SetName(wxString const &name);
+    void SetSimpleValue(wxString const &value) { assert(m_type == Simple); m_value.simple = value; m_raw_simple = Span(); }
 
+    // The span must stay valid until Materialize() is called or the value is destroyed.
+    void SetName(Span const &name) { m_name.clear(); m_raw_name = name; m_atom = FindAtom(name.data, name.length); }
+    // If 'unescape' is set the escaped quotes are replaced when the value is converted.
+    void SetSimpleValue(Span const &value, bool unescape);
 
     Type GetType() const { return m_type; }
     void SetType(Type type);
-    wxString const & GetName() const { return m_name; }
-    wxString const & GetSimpleValue() const { assert(m_type == Simple); return m_value.simple; }
+    wxString const & GetName() const
+    {
+        if(not m_raw_name.IsNull())
+        {
+            m_name = m_raw_name.ToString();
+            m_raw_name = Span();
+        }
+        return m_name;
+    }
+    wxString const & GetSimpleValue() const
+    {
+        assert(m_type == Simple);
+        if(not m_raw_simple.IsNull())
+            ConvertSimpleValue();
+        return m_value.simple;
+    }
 
-    int GetTupleSize() const { assert(m_type != Simple); return m_value.tuple.size(); }
+    int GetTupleSize() const { assert(m_type != Simple); Decode(); return m_value.tuple.size(); }
 
     void SetTupleValue(ResultValue *value);
     ResultValue const * GetTupleValue(wxString const &key) const;
+    // Faster versions, no name conversion or hashing per call
+    ResultValue const * GetTupleValue(Atom key) const;
+    ResultValue const * GetTupleValue(KeyPath const &key) const;
+    Atom GetAtom() const { return m_atom; }
     ResultValue const* GetTupleValueByIndex(int index) const;
     wxString MakeDebugString() const;
+
+    // Convert all pending spans, so the value no longer depends on the record buffer.
+    void Materialize();
+    // Reports the children to 'visitor' with the spans the parser left in the record, the
+    // events are the same as VisitValue's. It's only possible while CanVisit() is true:
+    // nothing pending and no name or value converted to a wxString yet.
+    bool CanVisit() const;
+    bool VisitChildren(ResultVisitor &visitor) const;
+    // Drops the name, the value and all children.
+    void Clear();
+
+    // Lazy tuples/lists: the children are decoded from the record when they are
+    // first accessed; 'start' is the position after the opening bracket.
+    void SetPending(int start) { assert(m_type != Simple); m_pending_start = start; }
+    bool IsPending() const { return m_pending_start >= 0; }
+
+    ResultArena* GetArena() const { return m_value.tuple.get_allocator().arena; }
+
+    // Creates a value in 'arena' (on the heap if it is NULL), Destroy() must get the same arena.
+    static ResultValue* Create(ResultArena *arena);
+    static void Destroy(ResultValue *value, ResultArena *arena);
 private:
-    Container::iterator FindTupleValue(wxChar const *name)
+    void ConvertSimpleValue() const;
+    bool NameEquals(char const *name, int length) const;
+    void Decode() const
     {
-        for(Container::iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
-        {
-            if((*it)->GetName() == name)
-                return it;
-        }
-        return m_value.tuple.end();
+        if(m_pending_start >= 0)
+            DecodePending();
     }
-    Container::const_iterator FindTupleValue(wxChar const *name) const
+    void DecodePending() const;
+    ResultValue const & Decoded() const { Decode(); return *this; }
+
+    // 'atom' must be FindAtom(name, length)
+    ResultValue const * FindTupleValue(Atom atom, char const *name, int length) const
     {
+        Decode();
+        if(atom != Atom_Unknown)
+        {
+            for(Container::const_iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
+            {
+                if((*it)->m_atom == atom)
+                    return *it;
+            }
+            return NULL;
+        }
         for(Container::const_iterator it = m_value.tuple.begin(); it != m_value.tuple.end(); ++it)
         {
-            if((*it)->GetName() == name)
-                return it;
+            if((*it)->m_atom == Atom_Unknown && (*it)->NameEquals(name, length))
+                return *it;
         }
-        return m_value.tuple.end();
+        return NULL;
     }
 private:
-    wxString m_name;
+    mutable wxString m_name;
+    Atom             m_atom;
+    mutable Span     m_raw_name;
+    mutable Span     m_raw_simple;
     Type     m_type;
+    bool     m_unescape;
+    mutable int m_pending_start;
 
     struct Value
     {
@@ -106,6 +310,11 @@ private:
         }
 
         Value() {}
+        explicit Value(ResultArena *arena) :
+            tuple(Container::allocator_type(arena))
+        {
+        }
+        // copies always live on the heap
         Value(Value const &v) :
             simple(v.simple)
         {
@@ -116,8 +325,16 @@ private:
         }
         ~Value()
         {
+            Clear();
+        }
+
+        void Clear()
+        {
+            ResultArena *arena = tuple.get_allocator().arena;
             for(Container::const_iterator it = tuple.begin(); it != tuple.end(); ++it)
-                delete *it;
+                ResultValue::Destroy(*it, arena);
+            tuple.clear();
+            simple.clear();
         }
 
         Value const& operator =(Value v)
@@ -126,10 +343,26 @@ private:
             return *this;
         }
 
-    } m_value;
+    };
+    mutable Value m_value;
 };
 
 bool ParseValue(wxString const &str, ResultValue &results, int start = 0);
+// Parses the UTF-8 record in place; 'results' keeps spans into 'buffer'.
+bool ParseValue(char const *buffer, int length, ResultValue &results, int start = 0);
+
+struct RecordHeader;
+
+// The time={wallclock,user,system} tuple GDB appends to the result records
+// after -enable-timings, in microseconds.
+struct GDBTimings
+{
+    GDBTimings() : wallclock(0), user(0), system(0) {}
+
+    int64_t wallclock;
+    int64_t user;
+    int64_t system;
+};
 
 class ResultParser
 {
@@ -163,8 +396,43 @@ public:
     bool operator !=(ResultParser const &o) const { return !(*this == o); }
 
 public:
+    ResultParser() :
+        m_type(TypeUnknown),
+        m_class(ClassUnknown),
+        m_value(&m_arena),
+        m_value_start(-1),
+        m_parseError(false),
+        m_lazy(false),
+        m_has_timings(false)
+    {
+    }
+    // the copy doesn't use an arena, its values are on the heap
+    ResultParser(ResultParser const &o) :
+        m_type(o.m_type),
+        m_class(o.m_class),
+        m_value(o.m_value),
+        m_async_type(o.m_async_type),
+        m_value_start(-1),
+        m_parseError(o.GetParseError()), // m_value is copied, so decoded, first
+        m_lazy(o.m_lazy),
+        m_timings(o.m_timings),
+        m_has_timings(o.m_has_timings)
+    {
+    }
+
     bool Parse(wxString const &str);
+    // Takes over the raw UTF-8 bytes of the record (utf8 is left empty);
+    // the fields are converted to wxString on demand.
+    bool Parse(std::string &utf8);
+    // Same, but the record is a whole output line already classified by DecodeRecordHeader.
+    bool Parse(std::string &line, RecordHeader const &header);
+
+    // In lazy mode nested tuples and lists are only checked for matching brackets and
+    // decoded when they are first accessed. A malformed one is only reported by
+    // GetParseError() after that, so the default is to parse everything at once.
+    void SetLazy(bool lazy) { m_lazy = lazy; }
     static Type ParseType(wxString const &str);
+    static Type ParseType(char first_char);
 
     wxString MakeDebugString() const;
     Type GetResultType() const { return m_type; }
@@ -174,17 +442,65 @@ public:
 
     ResultValue const & GetResultValue() const { return m_value; }
 
+    // Reports the results to 'visitor' straight from the record, without building the tree.
+    // If the tree was built already (an eager parse) it's walked instead. Returns false if there are no results (copies have no record), they are malformed
+    // or the visitor has stopped.
+    bool Visit(ResultVisitor &visitor) const;
+
     void SetParseError(bool tf) {m_parseError = tf;}
-    bool GetParseError() const {return m_parseError;}
+    bool GetParseError() const {return m_parseError || m_arena.HasDecodeError();}
 
+    // The time= tuple is taken off the results of a result record, so the
+    // values look the same with and without -enable-timings.
+    bool HasTimings() const { return m_has_timings; }
+    GDBTimings const & GetTimings() const { return m_timings; }
+
+private:
+    ResultParser& operator =(ResultParser const &);
 private:
+    std::string m_buffer; // UTF-8 record, m_value points into it
+    ResultArena m_arena;  // the nodes of m_value, must be declared before it
     Type m_type;
     Class m_class;
     ResultValue m_value;
     wxString m_async_type;
+    int m_value_start; // position of the results in m_buffer, -1 if there are none
     bool m_parseError;
+    bool m_lazy;
+    GDBTimings m_timings;
+    bool m_has_timings;
 };
 
+// The part of a MI output line before the results: [token] prefix class
+// e.g. 120000000003^done,value="1". The positions are byte offsets in the line.
+struct RecordHeader
+{
+    RecordHeader() :
+        prefix(0),
+        type(ResultParser::TypeUnknown),
+        result_class(ResultParser::ClassUnknown),
+        has_token(false),
+        action(-1),
+        command(-1),
+        prefix_pos(0),
+        class_end(0)
+    {
+    }
+
+    char prefix;    // one of ^*+=~@&
+    ResultParser::Type type;
+    ResultParser::Class result_class;
+    bool has_token;
+    int32_t action, command; // the token split like CommandID::ToString() joins it
+    int prefix_pos; // position of the prefix char
+    int class_end;  // end of the result class or of the async notify type
+};
+
+// Classifies the prefix, the token and the result class of 'line' in one pass over the bytes.
+// A token is the action ID followed by the 10 digits of the command ID. Lines without a token
+// are accepted only if they are result or async records (^*+=). Returns false for other lines.
+bool DecodeRecordHeader(char const *line, int length, RecordHeader &header);
+
 inline bool ToInt(ResultValue const &value, int &result_value)
 {
     assert(value.GetType() == ResultValue::Simple);
@@ -199,7 +515,9 @@ inline bool ToInt(ResultValue const &value, int &result_value)
         return false;
 }
 
-inline bool Lookup(ResultValue const &value, wxString const &name, int &result_value)
+// 'Key' is a wxString, an Atom or a KeyPath
+template<typename Key>
+inline bool Lookup(ResultValue const &value, Key const &name, int &result_value)
 {
     assert(value.GetType() != ResultValue::Simple);
     ResultValue const *v = value.GetTupleValue(name);
@@ -209,7 +527,8 @@ inline bool Lookup(ResultValue const &value, wxString const &name, int &result_v
     return ToInt(*v, result_value);
 }
 
-inline bool Lookup(ResultValue const &value, wxString const &name, bool &result_value)
+template<typename Key>
+inline bool Lookup(ResultValue const &value, Key const &name, bool &result_value)
 {
     assert(value.GetType() != ResultValue::Simple);
     ResultValue const *v = value.GetTupleValue(name);
@@ -227,7 +546,8 @@ inline bool Lookup(ResultValue const &value, wxString const &name, bool &result_
     return true;
 }
 
-inline bool Lookup(ResultValue const &value, wxString const &name, wxString &result_value)
+template<typename Key>
+inline bool Lookup(ResultValue const &value, Key const &name, wxString &result_value)
 {
     assert(value.GetType() != ResultValue::Simple);
     ResultValue const *v = value.GetTupleValue(name);
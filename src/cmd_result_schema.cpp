@@ -0,0 +1,115 @@
+#include "cmd_result_schema.h"
+
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+
+namespace dbg_mi
+{
+
+bool FieldValue::GetPlainBytes(Span &bytes) const
+{
+    if(m_value)
+        return false;
+    bytes = m_token;
+    if(not StripEnclosingQuotes(bytes))
+        return false;
+    return std::memchr(bytes.data, '\\', bytes.length) == NULL;
+}
+
+wxString FieldValue::ToString() const
+{
+    if(m_value)
+        return m_value->GetSimpleValue();
+    return UnquoteValue(m_token);
+}
+
+bool FieldValue::ToLong(long &result, int base) const
+{
+    Span bytes;
+    char buffer[32];
+    if(not GetPlainBytes(bytes) || bytes.length >= static_cast<int>(sizeof(buffer)))
+        return ToString().ToLong(&result, base);
+    if(bytes.empty())
+        return false;
+
+    std::memcpy(buffer, bytes.data, bytes.length);
+    buffer[bytes.length] = '\0';
+    char *end;
+    errno = 0;
+    long value = std::strtol(buffer, &end, base);
+    if(*end != '\0' || errno != 0)
+        return false;
+    result = value;
+    return true;
+}
+
+bool FieldValue::ToULongLong(unsigned long long &result, int base) const
+{
+    Span bytes;
+    char buffer[32];
+    if(not GetPlainBytes(bytes) || bytes.length >= static_cast<int>(sizeof(buffer)))
+        return ToString().ToULongLong(&result, base);
+    if(bytes.empty())
+        return false;
+
+    std::memcpy(buffer, bytes.data, bytes.length);
+    buffer[bytes.length] = '\0';
+    char *end;
+    errno = 0;
+    unsigned long long value = std::strtoull(buffer, &end, base);
+    if(*end != '\0' || errno != 0)
+        return false;
+    result = value;
+    return true;
+}
+
+bool FieldValue::IsEqual(char const *str) const
+{
+    Span bytes;
+    if(GetPlainBytes(bytes))
+        return bytes == Span(str, std::strlen(str));
+    return ToString() == wxString::FromUTF8(str);
+}
+
+bool ConvertString(FieldValue const &value, wxString &result)
+{
+    result = value.ToString();
+    return true;
+}
+
+bool ConvertInt(FieldValue const &value, int &result)
+{
+    long l;
+    if(not value.ToLong(l))
+        return false;
+    result = l;
+    return true;
+}
+
+bool ConvertBool(FieldValue const &value, bool &result)
+{
+    if(value.IsEqual("true"))
+        result = true;
+    else if(value.IsEqual("false"))
+        result = false;
+    else
+        return false;
+    return true;
+}
+
+bool ConvertFlag(FieldValue const &value, bool &result)
+{
+    int i;
+    if(not ConvertInt(value, i))
+        return false;
+    result = (i == 1);
+    return true;
+}
+
+bool ConvertAddress(FieldValue const &value, unsigned long long &result)
+{
+    return value.ToULongLong(result, 16);
+}
+
+} // namespace dbg_mi
@@ -0,0 +1,244 @@
+#ifndef _DEBUGGER_MI_CMD_RESULT_SCHEMA_H_
+#define _DEBUGGER_MI_CMD_RESULT_SCHEMA_H_
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <vector>
+#include <wx/string.h>
+
+#include "cmd_result_atoms.h"
+#include "cmd_result_parser.h"
+#include "cmd_result_tokens.h"
+#include "cmd_result_visitor.h"
+
+namespace dbg_mi
+{
+
+// A simple value of a record field, either a token of the record or a value of a parsed tuple.
+class FieldValue
+{
+public:
+    // 'token' is the value as it is in the record, with the quotes
+    explicit FieldValue(Span const &token) :
+        m_token(token),
+        m_value(NULL)
+    {
+    }
+    explicit FieldValue(ResultValue const &value) :
+        m_value(&value)
+    {
+    }
+
+    bool IsSimple() const { return not m_value || m_value->GetType() == ResultValue::Simple; }
+
+    wxString ToString() const;
+    // The numbers are parsed straight from the bytes when possible
+    bool ToLong(long &result, int base = 10) const;
+    bool ToULongLong(unsigned long long &result, int base = 10) const;
+    bool IsEqual(char const *str) const;
+private:
+    bool GetPlainBytes(Span &bytes) const;
+private:
+    Span m_token;
+    ResultValue const *m_value;
+};
+
+// Converters for the common field types, they fail if the value has the wrong format.
+bool ConvertString(FieldValue const &value, wxString &result);
+bool ConvertInt(FieldValue const &value, int &result);
+bool ConvertBool(FieldValue const &value, bool &result);    // "true"/"false"
+bool ConvertFlag(FieldValue const &value, bool &result);    // "1" is true, other numbers false
+bool ConvertAddress(FieldValue const &value, unsigned long long &result);
+
+// Which fields of a record have been seen.
+struct DecodedFields
+{
+    // the field is in the record and has been converted
+    bool Has(Atom field) const { return found[field] && not invalid[field]; }
+    bool Found(Atom field) const { return found[field]; }
+    bool IsInvalid(Atom field) const { return invalid[field]; }
+
+    std::bitset<Atom_Count> found;
+    std::bitset<Atom_Count> invalid; // found, but the value couldn't be converted
+};
+
+// Converts the value and stores it in 'Member' of the record.
+template<typename Record, typename T, T Record::*Member, bool (*Convert)(FieldValue const &, T &)>
+bool ConvertMember(FieldValue const &value, Record &record)
+{
+    return Convert(value, record.*Member);
+}
+
+// One entry of a record layout: the field name, the member it goes to and its converter.
+// Used inside the record class, the members can be private.
+#define DBG_MI_RECORD_FIELD(Record, field, member, convert) \
+    { dbg_mi::Atom_##field, &dbg_mi::ConvertMember<Record, decltype(Record::member), &Record::member, convert> }
+
+// Layout of a MI record (e.g. a frame or a var-update entry), declared once as an array of
+// DBG_MI_RECORD_FIELD entries. The field of a name is found with a table lookup.
+// Only simple fields are decoded; if a name repeats, the first one wins like in GetTupleValue.
+template<typename Record>
+class RecordSchema
+{
+public:
+    typedef bool (*Converter)(FieldValue const &value, Record &record);
+    struct Field
+    {
+        Atom atom;
+        Converter convert;
+    };
+public:
+    template<size_t N>
+    explicit RecordSchema(Field const (&fields)[N]) :
+        m_fields(fields, fields + N)
+    {
+        static_assert(N < 128, "too many fields in a record");
+        std::fill(m_slots, m_slots + Atom_Count, -1);
+        for(size_t ii = 0; ii < N; ++ii)
+        {
+            assert(fields[ii].atom != Atom_Unknown && m_slots[fields[ii].atom] == -1);
+            m_slots[fields[ii].atom] = ii;
+        }
+    }
+
+    bool Set(Atom atom, FieldValue const &value, Record &record, DecodedFields &decoded) const
+    {
+        int slot = m_slots[atom];
+        if(slot == -1 || decoded.found[atom])
+            return false;
+        decoded.found[atom] = true;
+        if(not value.IsSimple() || not m_fields[slot].convert(value, record))
+        {
+            decoded.invalid[atom] = true;
+            return false;
+        }
+        return true;
+    }
+
+    // Fills the record from the fields of a parsed tuple.
+    DecodedFields Decode(ResultValue const &tuple, Record &record) const
+    {
+        DecodedFields decoded;
+        if(tuple.GetType() == ResultValue::Simple)
+            return decoded;
+        int count = tuple.GetTupleSize();
+        for(int ii = 0; ii < count; ++ii)
+        {
+            ResultValue const *value = tuple.GetTupleValueByIndex(ii);
+            if(value->GetAtom() != Atom_Unknown)
+                Set(value->GetAtom(), FieldValue(*value), record, decoded);
+        }
+        return decoded;
+    }
+private:
+    std::vector<Field> m_fields;
+    signed char m_slots[Atom_Count];
+};
+
+// Decodes the tuples of a top level list (e.g. stack=[frame={..},..]) straight from the
+// events of the record, no tree is built. Nested values of the tuples are skipped.
+template<typename Record>
+class RecordListVisitor : public ResultVisitor
+{
+public:
+    // 'item' is the name of the tuples in the list, Atom_Unknown accepts any tuple
+    RecordListVisitor(Atom list, Atom item, RecordSchema<Record> const &schema) :
+        m_schema(schema),
+        m_list(list),
+        m_item(item),
+        m_depth(0),
+        m_count(0),
+        m_in_list(false),
+        m_in_record(false),
+        m_found(false)
+    {
+    }
+
+    virtual bool OnRecord(Record &record, DecodedFields const &fields, int index) = 0;
+
+    bool Found() const { return m_found; }
+    int GetCount() const { return m_count; }
+
+    virtual bool OnTupleStart(Span const &name)
+    {
+        if(m_in_list && m_depth == 1
+           && (m_item == Atom_Unknown || FindAtom(name.data, name.length) == m_item))
+        {
+            m_in_record = true;
+            m_record = Record();
+            m_fields = DecodedFields();
+        }
+        ++m_depth;
+        return true;
+    }
+    virtual bool OnTupleEnd()
+    {
+        --m_depth;
+        if(m_in_record && m_depth == 1)
+        {
+            m_in_record = false;
+            return OnRecord(m_record, m_fields, m_count++);
+        }
+        return true;
+    }
+    virtual bool OnListStart(Span const &name)
+    {
+        if(m_depth == 0 && not m_found && FindAtom(name.data, name.length) == m_list)
+        {
+            m_in_list = true;
+            m_found = true;
+        }
+        ++m_depth;
+        return true;
+    }
+    virtual bool OnListEnd()
+    {
+        --m_depth;
+        if(m_depth == 0)
+            m_in_list = false;
+        return true;
+    }
+    virtual bool OnValue(Span const &name, Span const &value)
+    {
+        if(m_in_record && m_depth == 2)
+            m_schema.Set(FindAtom(name.data, name.length), FieldValue(value), m_record, m_fields);
+        return true;
+    }
+private:
+    RecordSchema<Record> const &m_schema;
+    Record m_record;
+    DecodedFields m_fields;
+    Atom m_list, m_item;
+    int m_depth;
+    int m_count;
+    bool m_in_list, m_in_record;
+    bool m_found;
+};
+
+// Calls 'object.*callback' for each decoded record of the list.
+template<typename Record, typename T>
+class RecordListCallback : public RecordListVisitor<Record>
+{
+public:
+    typedef bool (T::*Callback)(Record &record, DecodedFields const &fields, int index);
+
+    RecordListCallback(Atom list, Atom item, RecordSchema<Record> const &schema, T &object, Callback callback) :
+        RecordListVisitor<Record>(list, item, schema),
+        m_object(object),
+        m_callback(callback)
+    {
+    }
+
+    virtual bool OnRecord(Record &record, DecodedFields const &fields, int index)
+    {
+        return (m_object.*m_callback)(record, fields, index);
+    }
+private:
+    T &m_object;
+    Callback m_callback;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_CMD_RESULT_SCHEMA_H_
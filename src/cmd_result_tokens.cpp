@@ -86,6 +86,106 @@ bool GetNextToken(wxString const &str, int pos, Token &token)
     }
 }
 
+bool GetNextToken(char const *buffer, int length, int pos, Token &token)
+{
+    while(pos < length && (buffer[pos] == ' ' || buffer[pos] == '\t'))
+        ++pos;
+
+    if(pos >= length)
+        return false;
+
+    token.start = -1;
+    bool in_quote = false;
+
+    switch(buffer[pos])
+    {
+    case '=':
+        token = Token(pos, pos + 1, Token::Equal);
+        return true;
+    case ',':
+        token = Token(pos, pos + 1, Token::Comma);
+        return true;
+    case '[':
+        token = Token(pos, pos + 1, Token::ListStart);
+        return true;
+    case ']':
+        token = Token(pos, pos + 1, Token::ListEnd);
+        return true;
+    case '{':
+        token = Token(pos, pos + 1, Token::TupleStart);
+        return true;
+    case '}':
+        token = Token(pos, pos + 1, Token::TupleEnd);
+        return true;
+
+    case '"':
+        in_quote = true;
+        /* FALLTHRU */
+    default:
+        token.type = Token::String;
+        token.start = pos;
+    }
+    ++pos;
+
+    if(in_quote)
+    {
+        while(pos < length)
+        {
+            if(buffer[pos] == '\\')
+                pos += 2; // skip the escaped char, so "\\" doesn't escape the closing quote
+            else if(buffer[pos] == '"')
+            {
+                token.end = pos + 1;
+                return true;
+            }
+            else
+                ++pos;
+        }
+        token.end = -1;
+        return false;
+    }
+
+    while(pos < length)
+    {
+        switch(buffer[pos])
+        {
+        case ' ':
+        case '\t':
+        case ',':
+        case '=':
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+            token.end = pos;
+            return true;
+        default:
+            ++pos;
+        }
+    }
+    token.end = pos;
+    return true;
+}
+
+// Checks the quotes of a value token, the enclosing quotes are removed from 'str'.
+bool StripEnclosingQuotes(Span &str)
+{
+    if(str.length == 0)
+        return true;
+    if(str.data[0] == '"')
+    {
+        // the tokenizer has already verified that the closing quote isn't escaped
+        if(str.length < 2 || str.data[str.length - 1] != '"')
+            return false;
+        str = Span(str.data + 1, str.length - 2);
+    }
+    else if(str.data[str.length - 1] == '"')
+    {
+        if(str.length >= 2 && str.data[str.length - 2] != '\\')
+            return false;
+    }
+    return true;
+}
 
 } // namespace dbg_mi
 
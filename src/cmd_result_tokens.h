@@ -1,11 +1,52 @@
 #ifndef _Debugger_GDB_MI_CMD_RESULT_TOKENIZE_H_
 #define _Debugger_GDB_MI_CMD_RESULT_TOKENIZE_H_
 
+#include <cassert>
+#include <cstring>
 #include <wx/string.h>
 
 namespace dbg_mi
 {
 
+// View into the raw UTF-8 bytes of a MI record. Nothing is copied;
+// the bytes are converted to a wxString only when ToString() is called.
+struct Span
+{
+    Span() :
+        data(NULL),
+        length(0)
+    {
+    }
+    Span(char const *data_, int length_) :
+        data(data_),
+        length(length_)
+    {
+    }
+
+    bool IsNull() const { return data == NULL; }
+    bool empty() const { return length == 0; }
+
+    bool operator == (Span const &s) const
+    {
+        return length == s.length && (length == 0 || std::memcmp(data, s.data, length) == 0);
+    }
+    bool operator != (Span const &s) const { return !(*this == s); }
+
+    bool StartsWith(char const *prefix) const
+    {
+        int prefix_length = std::strlen(prefix);
+        return prefix_length <= length && std::memcmp(data, prefix, prefix_length) == 0;
+    }
+
+    wxString ToString() const
+    {
+        return data ? wxString::FromUTF8(data, length) : wxString();
+    }
+
+    char const *data;
+    int length;
+};
+
 struct Token
 {
     enum Type
@@ -41,12 +82,29 @@ struct Token
         return s.substr(start, end - start);
     }
 
+    // start/end are byte offsets when the token comes from the UTF-8 tokenizer
+    Span GetSpan(char const *buffer) const
+    {
+        return Span(buffer + start, end - start);
+    }
+    wxString ExtractString(char const *buffer) const
+    {
+        return GetSpan(buffer).ToString();
+    }
+
     int start, end;
     Type type;
 };
 
 bool GetNextToken(wxString const &str, int pos, Token &token);
 
+// Same as above, but works directly on the UTF-8 bytes of the record.
+// All structural characters are ASCII, so multi-byte sequences are never split.
+bool GetNextToken(char const *buffer, int length, int pos, Token &token);
+
+// Validates the quotes of a value token and removes the enclosing ones.
+bool StripEnclosingQuotes(Span &str);
+
 } // namespace dbg_mi
 
 #endif // _Debugger_GDB_MI_CMD_RESULT_TOKENIZE_H_
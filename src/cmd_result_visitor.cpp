@@ -0,0 +1,286 @@
+#include "cmd_result_visitor.h"
+
+namespace dbg_mi
+{
+
+// Mirrors ParseTuple, the values are reported to the visitor instead of added to a tuple.
+static bool VisitTuple(char const *buffer, int length, int &start, bool is_list, bool want_closing_brace,
+                       ResultVisitor &visitor)
+{
+    Token token;
+    int pos = start;
+    bool has_value = false;
+    Span name;
+
+    enum Step
+    {
+        Nothing,
+        Name,
+        Equal,
+        Value
+    };
+    Step step = Nothing;
+
+    while(pos < length)
+    {
+        if(not GetNextToken(buffer, length, pos, token))
+            return false;
+
+        switch(token.type)
+        {
+        case Token::String:
+            if(has_value)
+            {
+                if(step != Equal)
+                    return false;
+                step = Value;
+
+                Span value = token.GetSpan(buffer);
+                Span stripped = value;
+                if(not StripEnclosingQuotes(stripped))
+                    return false;
+                if(not visitor.OnValue(name, value))
+                    return false;
+            }
+            else
+            {
+                if(step != Nothing)
+                    return false;
+                step = Name;
+                has_value = true;
+                name = token.GetSpan(buffer);
+            }
+            break;
+
+        case Token::Equal:
+            if(not has_value || step != Name)
+                return false;
+            step = Equal;
+            break;
+
+        case Token::Comma:
+            if(not has_value)
+                return false;
+            if(is_list && step == Name)
+            {
+                // list item without a name, the token is the value
+                if(not visitor.OnValue(Span(), name))
+                    return false;
+            }
+            else if(step != Value)
+                return false;
+            has_value = false;
+            step = Nothing;
+            break;
+
+        case Token::TupleStart:
+            if(not has_value)
+            {
+                if(not is_list)
+                    return false;
+                has_value = true;
+                name = Span();
+                step = Equal;
+            }
+            if(step != Equal)
+                return false;
+
+            pos = token.end;
+            if(not visitor.OnTupleStart(name))
+                return false;
+            if(not VisitTuple(buffer, length, pos, false, true, visitor))
+                return false;
+            if(not visitor.OnTupleEnd())
+                return false;
+            token.end = pos;
+            token.type = Token::TupleEnd;
+            step = Value;
+            break;
+
+        case Token::ListStart:
+            if(not has_value || step != Equal)
+                return false;
+
+            pos = token.end;
+            if(not visitor.OnListStart(name))
+                return false;
+            if(not VisitTuple(buffer, length, pos, true, true, visitor))
+                return false;
+            if(not visitor.OnListEnd())
+                return false;
+            token.end = pos;
+            token.type = Token::ListEnd;
+            step = Value;
+            break;
+
+        case Token::TupleEnd:
+            if(not has_value || is_list || !want_closing_brace || step != Value)
+                return false;
+            start = token.end;
+            return true;
+
+        case Token::ListEnd:
+            if(not is_list || !want_closing_brace)
+                return false;
+            if(step == Name)
+            {
+                if(not visitor.OnValue(Span(), name))
+                    return false;
+            }
+            else if(step != Value && (step != Nothing || has_value))
+                return false;
+            start = token.end;
+            return true;
+
+        default:
+            assert(false);
+        }
+
+        pos = token.end;
+    }
+
+    if(has_value && step != Value)
+        return false;
+    if(token.type == Token::Comma || token.type == Token::ListStart || token.type == Token::TupleStart)
+        return false;
+
+    // if we are here the closing brace was not found
+    if(want_closing_brace)
+        return false;
+
+    start = pos;
+    return true;
+}
+
+bool VisitValue(char const *buffer, int length, ResultVisitor &visitor, int start)
+{
+    return VisitTuple(buffer, length, start, false, false, visitor);
+}
+
+wxString UnquoteValue(Span const &value)
+{
+    Span str = value;
+    StripEnclosingQuotes(str);
+    // same conversion as the values of a parsed tuple
+    ResultValue converted;
+    converted.SetSimpleValue(str, true);
+    return converted.GetSimpleValue();
+}
+
+ResultListVisitor::ResultListVisitor(Atom list) :
+    m_list(list),
+    m_depth(0),
+    m_count(0),
+    m_in_list(false),
+    m_found(false)
+{
+}
+
+ResultListVisitor::~ResultListVisitor()
+{
+}
+
+bool ResultListVisitor::OnTupleStart(Span const &name)
+{
+    bool result = StartValue(name, ResultValue::Tuple);
+    ++m_depth;
+    return result;
+}
+
+bool ResultListVisitor::OnTupleEnd()
+{
+    --m_depth;
+    return EndValue();
+}
+
+bool ResultListVisitor::OnListStart(Span const &name)
+{
+    bool result = true;
+    if(m_depth == 0 && FindAtom(name.data, name.length) == m_list && not m_found)
+    {
+        m_in_list = true;
+        m_found = true;
+    }
+    else
+        result = StartValue(name, ResultValue::Array);
+    ++m_depth;
+    return result;
+}
+
+bool ResultListVisitor::OnListEnd()
+{
+    --m_depth;
+    if(m_in_list && m_depth == 0)
+    {
+        m_in_list = false;
+        return true;
+    }
+    return EndValue();
+}
+
+bool ResultListVisitor::OnValue(Span const &name, Span const &value)
+{
+    if(m_stack.empty() && not (m_in_list && m_depth == 1))
+        return true;
+
+    Span str = value;
+    bool unescape = not name.empty();
+    // list items keep their quotes, like in the parsed tree
+    if(unescape)
+        StripEnclosingQuotes(str);
+
+    if(m_stack.empty())
+    {
+        m_item.Clear();
+        m_item.SetType(ResultValue::Simple);
+        m_item.SetName(name);
+        m_item.SetSimpleValue(str, unescape);
+        return EmitItem();
+    }
+
+    ResultValue *child = ResultValue::Create(NULL);
+    child->SetName(name);
+    child->SetSimpleValue(str, unescape);
+    m_stack.back()->SetTupleValue(child);
+    return true;
+}
+
+bool ResultListVisitor::StartValue(Span const &name, ResultValue::Type type)
+{
+    if(not m_stack.empty())
+    {
+        ResultValue *child = ResultValue::Create(NULL);
+        child->SetType(type);
+        child->SetName(name);
+        m_stack.back()->SetTupleValue(child);
+        m_stack.push_back(child);
+    }
+    else if(m_in_list && m_depth == 1)
+    {
+        m_item.Clear();
+        m_item.SetType(type);
+        m_item.SetName(name);
+        m_stack.push_back(&m_item);
+    }
+    return true;
+}
+
+bool ResultListVisitor::EndValue()
+{
+    if(m_stack.empty())
+        return true;
+    m_stack.pop_back();
+    if(not m_stack.empty())
+        return true;
+    return EmitItem();
+}
+
+bool ResultListVisitor::EmitItem()
+{
+    bool result = OnItem(m_item, m_count++);
+    m_item.Clear();
+    m_item.SetType(ResultValue::Simple);
+    return result;
+}
+
+} // namespace dbg_mi
@@ -0,0 +1,98 @@
+#ifndef _DEBUGGER_MI_CMD_RESULT_VISITOR_H_
+#define _DEBUGGER_MI_CMD_RESULT_VISITOR_H_
+
+#include <vector>
+
+#include "cmd_result_atoms.h"
+#include "cmd_result_parser.h"
+#include "cmd_result_tokens.h"
+
+namespace dbg_mi
+{
+
+// Event interface to the results of a MI record, the values are reported in the order
+// they are tokenized and no tree is built. The spans point into the record.
+// The results of the record itself are not wrapped in a tuple, so the top level fields
+// are reported at depth 0. Items of a list have no name (the span is empty).
+// Return false from a callback to stop the parsing.
+class ResultVisitor
+{
+public:
+    virtual ~ResultVisitor() {}
+
+    virtual bool OnTupleStart(Span const & /*name*/) { return true; }
+    virtual bool OnTupleEnd() { return true; }
+    virtual bool OnListStart(Span const & /*name*/) { return true; }
+    virtual bool OnListEnd() { return true; }
+    // 'value' is the token as it is in the record, use UnquoteValue() to get the string
+    virtual bool OnValue(Span const & /*name*/, Span const & /*value*/) { return true; }
+};
+
+// Reports the results in 'buffer' (the part after the record class) to 'visitor'.
+// The grammar is the same as ParseValue's, but the events before an error have been
+// delivered already. Returns false if the results are malformed or the visitor stopped.
+bool VisitValue(char const *buffer, int length, ResultVisitor &visitor, int start = 0);
+
+// The string of a value token: the enclosing quotes are removed and the escaped quotes replaced.
+wxString UnquoteValue(Span const &value);
+
+// Builds the items of a top level list (e.g. 'stack' or 'children') one at a time,
+// so only one item is in memory while the list is parsed.
+// The items are the same as GetTupleValueByIndex() would return for the parsed list.
+class ResultListVisitor : public ResultVisitor
+{
+public:
+    explicit ResultListVisitor(Atom list);
+    virtual ~ResultListVisitor();
+
+    // 'item' is destroyed after the call
+    virtual bool OnItem(ResultValue const &item, int index) = 0;
+
+    bool Found() const { return m_found; }
+    int GetCount() const { return m_count; }
+
+    virtual bool OnTupleStart(Span const &name);
+    virtual bool OnTupleEnd();
+    virtual bool OnListStart(Span const &name);
+    virtual bool OnListEnd();
+    virtual bool OnValue(Span const &name, Span const &value);
+private:
+    bool StartValue(Span const &name, ResultValue::Type type);
+    bool EndValue();
+    bool EmitItem();
+private:
+    Atom m_list;
+    ResultValue m_item;
+    std::vector<ResultValue*> m_stack; // the open tuples/lists of m_item
+    int m_depth;
+    int m_count;
+    bool m_in_list;
+    bool m_found;
+};
+
+// Calls 'object.*callback' for each item of the list.
+template<typename T>
+class ResultListCallback : public ResultListVisitor
+{
+public:
+    typedef bool (T::*Callback)(ResultValue const &item, int index);
+
+    ResultListCallback(Atom list, T &object, Callback callback) :
+        ResultListVisitor(list),
+        m_object(object),
+        m_callback(callback)
+    {
+    }
+
+    virtual bool OnItem(ResultValue const &item, int index)
+    {
+        return (m_object.*m_callback)(item, index);
+    }
+private:
+    T &m_object;
+    Callback m_callback;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_CMD_RESULT_VISITOR_H_
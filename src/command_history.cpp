@@ -0,0 +1,157 @@
+#include "command_history.h"
+
+#include <wx/filename.h>
+
+namespace dbg_mi
+{
+
+CommandHistory::CommandHistory(int capacity) :
+    m_ring_start(0),
+    m_ring_count(0),
+    m_count(0),
+    m_journal_size(0),
+    m_journal_failed(false),
+    m_cached_block(-1)
+{
+    m_ring.resize(capacity > 0 ? capacity : 1);
+}
+
+CommandHistory::~CommandHistory()
+{
+    CloseJournal();
+}
+
+void CommandHistory::SetCapacity(int capacity)
+{
+    Clear();
+    m_ring.clear();
+    m_ring.resize(capacity > 0 ? capacity : 1);
+}
+
+void CommandHistory::Add(wxString const &command)
+{
+    int capacity = m_ring.size();
+    if(m_ring_count == capacity)
+    {
+        // the oldest command makes room
+        Spill(m_ring[m_ring_start]);
+        m_ring[m_ring_start] = command;
+        m_ring_start = (m_ring_start + 1) % capacity;
+    }
+    else
+    {
+        m_ring[(m_ring_start + m_ring_count) % capacity] = command;
+        ++m_ring_count;
+    }
+    ++m_count;
+}
+
+void CommandHistory::Clear()
+{
+    for(std::vector<wxString>::iterator it = m_ring.begin(); it != m_ring.end(); ++it)
+        it->clear();
+    m_ring_start = 0;
+    m_ring_count = 0;
+    m_count = 0;
+    CloseJournal();
+}
+
+wxString CommandHistory::Get(int index) const
+{
+    if(index < 0 || index >= m_count)
+        return wxEmptyString;
+
+    int journal_count = GetJournalCount();
+    if(index >= journal_count)
+        return m_ring[(m_ring_start + index - journal_count) % m_ring.size()];
+
+    int block = index / c_block_size;
+    if(not ReadJournalBlock(block))
+        return wxEmptyString;
+    size_t offset = index % c_block_size;
+    return offset < m_cached_commands.size() ? m_cached_commands[offset] : wxString();
+}
+
+void CommandHistory::Spill(wxString const &command)
+{
+    if(m_journal_failed)
+        return;
+    if(not m_journal.IsOpened())
+    {
+        m_journal_path = wxFileName::CreateTempFileName(_T("cb_gdbmi_commands"));
+        if(m_journal_path.empty() || not m_journal.Open(m_journal_path, wxFile::read_write))
+        {
+            m_journal_failed = true;
+            return;
+        }
+        m_journal_size = 0;
+    }
+
+    int spilled = GetJournalCount();
+    if(spilled % c_block_size == 0)
+        m_block_offsets.push_back(m_journal_size);
+
+    // one command per line, the commands sent to GDB are single lines anyway
+    wxString line(command);
+    line.Replace(_T("\n"), _T(" "));
+    line += _T('\n');
+    wxScopedCharBuffer utf8 = line.utf8_str();
+    m_journal.SeekEnd();
+    if(m_journal.Write(utf8.data(), utf8.length()) != utf8.length())
+    {
+        m_journal_failed = true;
+        return;
+    }
+    m_journal_size += utf8.length();
+    if(m_cached_block == spilled / c_block_size)
+        m_cached_block = -1; // the block has grown
+}
+
+bool CommandHistory::ReadJournalBlock(int block) const
+{
+    if(block == m_cached_block)
+        return true;
+    if(m_journal_failed || not m_journal.IsOpened() || block >= static_cast<int>(m_block_offsets.size()))
+        return false;
+
+    wxFileOffset start = m_block_offsets[block];
+    wxFileOffset end = block + 1 < static_cast<int>(m_block_offsets.size()) ? m_block_offsets[block + 1]
+                                                                             : m_journal_size;
+    std::string buffer(end - start, '\0');
+    if(m_journal.Seek(start) == wxInvalidOffset
+       || m_journal.Read(&buffer[0], buffer.length()) != static_cast<ssize_t>(buffer.length()))
+    {
+        return false;
+    }
+
+    m_cached_commands.clear();
+    std::string::size_type begin = 0;
+    while(begin < buffer.length())
+    {
+        std::string::size_type eol = buffer.find('\n', begin);
+        if(eol == std::string::npos)
+            eol = buffer.length();
+        m_cached_commands.push_back(wxString::FromUTF8(buffer.data() + begin, eol - begin));
+        begin = eol + 1;
+    }
+    m_cached_block = block;
+    return true;
+}
+
+void CommandHistory::CloseJournal()
+{
+    if(m_journal.IsOpened())
+        m_journal.Close();
+    if(not m_journal_path.empty())
+    {
+        wxRemoveFile(m_journal_path);
+        m_journal_path.clear();
+    }
+    m_journal_size = 0;
+    m_journal_failed = false;
+    m_block_offsets.clear();
+    m_cached_block = -1;
+    m_cached_commands.clear();
+}
+
+} // namespace dbg_mi
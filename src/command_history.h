@@ -0,0 +1,61 @@
+#ifndef _DEBUGGER_MI_COMMAND_HISTORY_H_
+#define _DEBUGGER_MI_COMMAND_HISTORY_H_
+
+#include <string>
+#include <vector>
+#include <wx/file.h>
+#include <wx/string.h>
+
+namespace dbg_mi
+{
+
+// The commands sent to GDB in this session. The last 'capacity' commands are kept
+// in memory, the older ones are moved to a journal in a temporary file and read
+// back a block at a time when they are asked for.
+class CommandHistory
+{
+    CommandHistory(CommandHistory const &);
+    CommandHistory& operator =(CommandHistory const &);
+public:
+    explicit CommandHistory(int capacity = c_default_capacity);
+    ~CommandHistory();
+
+    // Clears the history
+    void SetCapacity(int capacity);
+    int GetCapacity() const { return m_ring.size(); }
+
+    void Add(wxString const &command);
+    void Clear();
+
+    // All the commands, the journal included
+    int GetCount() const { return m_count; }
+    int GetJournalCount() const { return m_count - m_ring_count; }
+    // Empty if 'index' is out of range or the journal can't be read
+    wxString Get(int index) const;
+private:
+    void Spill(wxString const &command);
+    bool ReadJournalBlock(int block) const;
+    void CloseJournal();
+private:
+    static int const c_default_capacity = 10000;
+    // the journal has the offset of every c_block_size-th command
+    static int const c_block_size = 256;
+
+    std::vector<wxString> m_ring;
+    int m_ring_start;
+    int m_ring_count;
+    int m_count;
+
+    wxString m_journal_path;
+    mutable wxFile m_journal;
+    wxFileOffset m_journal_size;
+    bool m_journal_failed; // the older commands are dropped
+    std::vector<wxFileOffset> m_block_offsets;
+
+    mutable int m_cached_block;
+    mutable std::vector<wxString> m_cached_commands;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_COMMAND_HISTORY_H_
@@ -0,0 +1,199 @@
+#include "command_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <wx/filename.h>
+
+#include "json_node.h"
+
+namespace dbg_mi
+{
+
+void LatencyHistogram::Add(int64_t microseconds)
+{
+    if(microseconds < 0)
+        microseconds = 0;
+    int bucket = 0;
+    while(bucket < BucketCount - 1 && microseconds >= GetBucketBound(bucket))
+        ++bucket;
+    ++m_buckets[bucket];
+    if(m_count == 0 || microseconds < m_min)
+        m_min = microseconds;
+    if(m_count == 0 || microseconds > m_max)
+        m_max = microseconds;
+    ++m_count;
+    m_sum += microseconds;
+}
+
+void LatencyHistogram::Clear()
+{
+    for(int ii = 0; ii < BucketCount; ++ii)
+        m_buckets[ii] = 0;
+    m_count = 0;
+    m_sum = m_min = m_max = 0;
+}
+
+int64_t LatencyHistogram::GetPercentile(int percent) const
+{
+    if(m_count == 0)
+        return 0;
+    // the rank of the percentile, rounded up
+    int64_t rank = (int64_t(m_count) * percent + 99) / 100;
+    int64_t seen = 0;
+    for(int ii = 0; ii < BucketCount; ++ii)
+    {
+        seen += m_buckets[ii];
+        if(seen >= rank && seen > 0)
+            return std::min(GetBucketBound(ii), m_max);
+    }
+    return m_max;
+}
+
+int64_t CommandStats::Now()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+wxString CommandStats::GetVerb(wxString const &command)
+{
+    wxString verb = command.BeforeFirst(_T(' '));
+    return verb.empty() ? wxString(_T("(empty)")) : verb;
+}
+
+wxString CommandStats::GetStageName(Stage stage)
+{
+    switch(stage)
+    {
+        case StageGDB:      return _T("gdb");
+        case StageParse:    return _T("parse");
+        case StageQueue:    return _T("queue");
+        case StageCallback: return _T("callback");
+        case StageTotal:    return _T("total");
+        case StageFinish:   return _T("finish");
+        case StageGDBWall:  return _T("gdb-wall");
+        case StageGDBCpu:   return _T("gdb-cpu");
+        default:            return _T("unknown");
+    }
+}
+
+void CommandStats::Add(wxString const &verb, Stamps const &stamps)
+{
+    if(stamps.sent == 0 || stamps.callback_end == 0)
+        return;
+
+    VerbStats &stats = m_verbs[verb];
+    if(stamps.received)
+        stats.stages[StageGDB].Add(stamps.received - stamps.sent);
+    int64_t parsing = 0;
+    if(stamps.parse_start && stamps.parse_end)
+    {
+        parsing = stamps.parse_end - stamps.parse_start;
+        stats.stages[StageParse].Add(parsing);
+    }
+    if(stamps.received && stamps.callback)
+        stats.stages[StageQueue].Add(stamps.callback - stamps.received - parsing);
+    if(stamps.callback)
+        stats.stages[StageCallback].Add(stamps.callback_end - stamps.callback);
+    stats.stages[StageTotal].Add(stamps.callback_end - stamps.sent);
+    if(stamps.finished)
+        stats.stages[StageFinish].Add(stamps.callback_end - stamps.sent);
+    if(stamps.gdb_timed)
+    {
+        stats.stages[StageGDBWall].Add(stamps.gdb_wallclock);
+        stats.stages[StageGDBCpu].Add(stamps.gdb_cpu);
+    }
+}
+
+wxString CommandStats::FormatText() const
+{
+    wxString text = wxString::Format(_T("%-28s %-9s %7s %10s %10s %10s %10s %10s\n"),
+                                     _T("verb"), _T("stage"), _T("count"), _T("mean us"),
+                                     _T("p50 us"), _T("p90 us"), _T("p99 us"), _T("max us"));
+    for(Verbs::const_iterator it = m_verbs.begin(); it != m_verbs.end(); ++it)
+    {
+        for(int stage = 0; stage < StageCount; ++stage)
+        {
+            LatencyHistogram const &h = it->second.stages[stage];
+            if(h.GetCount() == 0)
+                continue;
+            text += wxString::Format(_T("%-28s %-9s %7d %10lld %10lld %10lld %10lld %10lld\n"),
+                                     it->first.c_str(), GetStageName(Stage(stage)).c_str(), h.GetCount(),
+                                     (long long)h.GetMean(), (long long)h.GetPercentile(50),
+                                     (long long)h.GetPercentile(90), (long long)h.GetPercentile(99),
+                                     (long long)h.GetMax());
+        }
+    }
+    return text;
+}
+
+wxString CommandStats::FormatCSV() const
+{
+    wxString csv = _T("verb,stage,bucket_us,count\n");
+    for(Verbs::const_iterator it = m_verbs.begin(); it != m_verbs.end(); ++it)
+    {
+        for(int stage = 0; stage < StageCount; ++stage)
+        {
+            LatencyHistogram const &h = it->second.stages[stage];
+            for(int ii = 0; ii < LatencyHistogram::BucketCount; ++ii)
+            {
+                if(h.GetBucket(ii) == 0)
+                    continue;
+                csv += wxString::Format(_T("%s,%s,%lld,%d\n"), it->first.c_str(),
+                                        GetStageName(Stage(stage)).c_str(),
+                                        (long long)LatencyHistogram::GetBucketBound(ii), h.GetBucket(ii));
+            }
+        }
+    }
+    return csv;
+}
+
+// JSONElement has no 64-bit numbers
+static long ToJSONNumber(int64_t value)
+{
+    return value > LONG_MAX ? LONG_MAX : long(value);
+}
+
+void CommandStats::SaveJSON(wxFileName const &filename) const
+{
+    JSONRoot root(cJSON_Object);
+    JSONElement verbs = JSONElement::createObject("verbs");
+    for(Verbs::const_iterator it = m_verbs.begin(); it != m_verbs.end(); ++it)
+    {
+        JSONElement verb = JSONElement::createObject(it->first);
+        for(int stage = 0; stage < StageCount; ++stage)
+        {
+            LatencyHistogram const &h = it->second.stages[stage];
+            if(h.GetCount() == 0)
+                continue;
+            JSONElement element = JSONElement::createObject(GetStageName(Stage(stage)));
+            element.addProperty(_T("count"), h.GetCount());
+            element.addProperty(_T("sum_us"), ToJSONNumber(h.GetSum()));
+            element.addProperty(_T("min_us"), ToJSONNumber(h.GetMin()));
+            element.addProperty(_T("max_us"), ToJSONNumber(h.GetMax()));
+            element.addProperty(_T("p50_us"), ToJSONNumber(h.GetPercentile(50)));
+            element.addProperty(_T("p90_us"), ToJSONNumber(h.GetPercentile(90)));
+            element.addProperty(_T("p99_us"), ToJSONNumber(h.GetPercentile(99)));
+
+            // the buckets in use with their upper bound
+            JSONElement buckets = JSONElement::createArray(_T("buckets"));
+            for(int ii = 0; ii < LatencyHistogram::BucketCount; ++ii)
+            {
+                if(h.GetBucket(ii) == 0)
+                    continue;
+                JSONElement bucket = JSONElement::createObject();
+                bucket.addProperty(_T("below_us"), ToJSONNumber(LatencyHistogram::GetBucketBound(ii)));
+                bucket.addProperty(_T("count"), h.GetBucket(ii));
+                buckets.arrayAppend(bucket);
+            }
+            element.addProperty(_T("buckets"), buckets);
+            verb.addProperty(GetStageName(Stage(stage)), element);
+        }
+        verbs.addProperty(it->first, verb);
+    }
+    root.toElement().addProperty(_T("verbs"), verbs);
+    root.save(filename);
+}
+
+} // namespace dbg_mi
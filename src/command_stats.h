@@ -0,0 +1,103 @@
+#ifndef _DEBUGGER_MI_COMMAND_STATS_H_
+#define _DEBUGGER_MI_COMMAND_STATS_H_
+
+#include <cstdint>
+#include <map>
+#include <wx/string.h>
+
+class wxFileName;
+
+namespace dbg_mi
+{
+
+// Latencies in microseconds, counted in power of 2 buckets.
+class LatencyHistogram
+{
+public:
+    enum { BucketCount = 32 };
+
+    LatencyHistogram() { Clear(); }
+
+    void Add(int64_t microseconds);
+    void Clear();
+
+    int GetCount() const { return m_count; }
+    int64_t GetSum() const { return m_sum; }
+    int64_t GetMin() const { return m_min; }
+    int64_t GetMax() const { return m_max; }
+    int64_t GetMean() const { return m_count ? m_sum / m_count : 0; }
+    // The upper bound of the bucket holding the 'percent' percentile.
+    int64_t GetPercentile(int percent) const;
+    int GetBucket(int index) const { return m_buckets[index]; }
+    // The latencies of the bucket 'index' are below this bound.
+    static int64_t GetBucketBound(int index) { return int64_t(1) << index; }
+private:
+    int m_buckets[BucketCount];
+    int m_count;
+    int64_t m_sum, m_min, m_max;
+};
+
+// Timings of the commands sent to GDB, aggregated by the MI verb (-var-update,
+// -stack-list-frames..) of the command.
+class CommandStats
+{
+public:
+    // The moments in the life of a command, 0 if it didn't happen.
+    struct Stamps
+    {
+        Stamps() : sent(0), received(0), parse_start(0), parse_end(0), callback(0), callback_end(0), finished(false),
+            gdb_wallclock(0), gdb_cpu(0), gdb_timed(false) {}
+
+        int64_t sent;           // written to GDB
+        int64_t received;       // the result record was framed
+        int64_t parse_start;
+        int64_t parse_end;
+        int64_t callback;       // the action got the result
+        int64_t callback_end;
+        bool finished;          // the action finished in the callback
+
+        // durations reported by GDB itself with -enable-timings
+        int64_t gdb_wallclock;
+        int64_t gdb_cpu;        // user + system
+        bool gdb_timed;
+    };
+    enum Stage
+    {
+        StageGDB = 0,   // sent -> received
+        StageParse,     // parse_start -> parse_end
+        StageQueue,     // received -> callback, minus the parsing
+        StageCallback,  // callback -> callback_end
+        StageTotal,     // sent -> callback_end
+        StageFinish,    // sent -> callback_end of the command which finished its action
+        StageGDBWall,   // the wallclock time GDB reported
+        StageGDBCpu,    // the user + system time GDB reported
+        StageCount
+    };
+    struct VerbStats
+    {
+        LatencyHistogram stages[StageCount];
+    };
+    typedef std::map<wxString, VerbStats> Verbs;
+public:
+    // Monotonic clock in microseconds, it can be read on any thread.
+    static int64_t Now();
+    // "-var-update 1 *" -> "-var-update"
+    static wxString GetVerb(wxString const &command);
+    static wxString GetStageName(Stage stage);
+
+    void Add(wxString const &verb, Stamps const &stamps);
+    void Clear() { m_verbs.clear(); }
+    Verbs const& GetVerbs() const { return m_verbs; }
+
+    // A table of the count, mean, p50, p90, p99 and max per verb and stage.
+    wxString FormatText() const;
+    // One row per verb, stage and bucket.
+    wxString FormatCSV() const;
+    void SaveJSON(wxFileName const &filename) const;
+private:
+    Verbs m_verbs;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_COMMAND_STATS_H_
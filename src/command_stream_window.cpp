@@ -0,0 +1,98 @@
+#include "command_stream_window.h"
+
+#include <sdk.h>
+#include <wx/button.h>
+#include <wx/clipbrd.h>
+#include <wx/sizer.h>
+
+#include "cmd_queue.h"
+
+namespace dbg_mi
+{
+
+// ----------------------------------------------------------------------------
+CommandStreamList::CommandStreamList(wxWindow *parent, Logger &logger) :
+// ----------------------------------------------------------------------------
+    wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize,
+               wxLC_REPORT | wxLC_VIRTUAL | wxLC_HRULES),
+    m_logger(logger)
+{
+    InsertColumn(0, _("#"), wxLIST_FORMAT_RIGHT, 70);
+    InsertColumn(1, _("Command"), wxLIST_FORMAT_LEFT, 640);
+}
+// ----------------------------------------------------------------------------
+wxString CommandStreamList::OnGetItemText(long item, long column) const
+// ----------------------------------------------------------------------------
+{
+    if (column == 0)
+        return wxString::Format(_T("%ld"), item + 1);
+    return m_logger.GetCommand(item);
+}
+// ----------------------------------------------------------------------------
+CommandStreamWindow::CommandStreamWindow(wxWindow *parent, Logger &logger) :
+// ----------------------------------------------------------------------------
+    wxScrollingDialog(parent, -1, _("Command stream"), wxDefaultPosition, wxSize(760, 420),
+                      wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER | wxMAXIMIZE_BOX | wxMINIMIZE_BOX),
+    m_logger(logger),
+    m_font(8, wxFONTFAMILY_MODERN, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL)
+{
+    wxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+    m_list = new CommandStreamList(this, logger);
+    m_list->SetFont(m_font);
+    sizer->Add(m_list, 1, wxGROW);
+
+    wxSizer* buttons = new wxBoxSizer(wxHORIZONTAL);
+    wxButton *refresh = new wxButton(this, wxID_ANY, _("Refresh"));
+    wxButton *copy = new wxButton(this, wxID_ANY, _("Copy selected"));
+    buttons->Add(refresh, 0, wxALL, 4);
+    buttons->AddStretchSpacer();
+    buttons->Add(copy, 0, wxALL, 4);
+    sizer->Add(buttons, 0, wxGROW);
+
+    refresh->Bind(wxEVT_BUTTON, &CommandStreamWindow::OnRefresh, this);
+    copy->Bind(wxEVT_BUTTON, &CommandStreamWindow::OnCopy, this);
+
+    SetSizer(sizer);
+    sizer->Layout();
+    UpdateCommands();
+}
+// ----------------------------------------------------------------------------
+void CommandStreamWindow::UpdateCommands()
+// ----------------------------------------------------------------------------
+{
+    long old_count = m_list->GetItemCount();
+    long count = m_logger.GetCommandCount();
+    // follow the end of the stream if it was visible
+    bool at_end = old_count == 0
+                  || m_list->GetTopItem() + m_list->GetCountPerPage() >= old_count;
+
+    m_list->SetItemCount(count);
+    m_list->Refresh();
+    if (at_end && count > 0)
+        m_list->EnsureVisible(count - 1);
+}
+// ----------------------------------------------------------------------------
+void CommandStreamWindow::OnRefresh(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    UpdateCommands();
+}
+// ----------------------------------------------------------------------------
+void CommandStreamWindow::OnCopy(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    wxString text;
+    long item = -1;
+    while ((item = m_list->GetNextItem(item, wxLIST_NEXT_ALL, wxLIST_STATE_SELECTED)) != -1)
+        text += m_logger.GetCommand(item) + _T("\n");
+    if (text.empty())
+        return;
+
+    if (wxTheClipboard->Open())
+    {
+        wxTheClipboard->SetData(new wxTextDataObject(text));
+        wxTheClipboard->Close();
+    }
+}
+
+} // namespace dbg_mi
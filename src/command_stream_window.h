@@ -0,0 +1,50 @@
+#ifndef _DEBUGGER_MI_COMMAND_STREAM_WINDOW_H_
+#define _DEBUGGER_MI_COMMAND_STREAM_WINDOW_H_
+
+#include <wx/font.h>
+#include <wx/listctrl.h>
+#include <scrollingdialog.h>
+
+class wxCommandEvent;
+
+namespace dbg_mi
+{
+
+class Logger;
+
+// Asks the logger only for the rows on screen, the history can be very long.
+// ----------------------------------------------------------------------------
+class CommandStreamList : public wxListCtrl
+// ----------------------------------------------------------------------------
+{
+    public:
+        CommandStreamList(wxWindow *parent, Logger &logger);
+
+        virtual wxString OnGetItemText(long item, long column) const;
+    private:
+        Logger &m_logger;
+};
+
+// The commands sent to GDB in this session
+// ----------------------------------------------------------------------------
+class CommandStreamWindow : public wxScrollingDialog
+// ----------------------------------------------------------------------------
+{
+    public:
+        CommandStreamWindow(wxWindow *parent, Logger &logger);
+
+        // Shows the commands added since, the list keeps its position
+        // unless the last command was visible.
+        void UpdateCommands();
+    private:
+        void OnRefresh(wxCommandEvent &event);
+        void OnCopy(wxCommandEvent &event);
+    private:
+        Logger &m_logger;
+        CommandStreamList *m_list;
+        wxFont m_font;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_COMMAND_STREAM_WINDOW_H_
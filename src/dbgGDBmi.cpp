@@ -9,6 +9,8 @@
 #include <wx/fileconf.h>
 #include <wx/tokenzr.h>
 #include <wx/busyinfo.h>
+#include <wx/numdlg.h>
+#include <wx/progdlg.h>
 
 #include <cbdebugger_interfaces.h>
 #include <compilerfactory.h>
@@ -41,6 +43,9 @@
 #include "projectloader_hooks.h"
 #include "debuggeroptionsprjdlg.h"
 #include "json_node.h" //save/load brakpoints
+#include "command_stream_window.h"
+#include "performance_window.h"
+#include "session_replay.h"
 
 #ifndef __WX_MSW__
 #include <dirent.h>
@@ -62,7 +67,17 @@ namespace
 
     int const id_gdb_process = wxNewId();
     int const id_gdb_poll_timer = wxNewId();
+    int const id_gdb_output_ready = wxNewId();
+
+    // With the output reader thread the timer is only a fallback, the results are
+    // dispatched when the reader wakes the GUI thread.
+    int const c_poll_interval = 20;
+    int const c_fallback_poll_interval = 250;
     int const id_menu_info_command_stream = wxNewId();
+    int const id_menu_mi_performance = wxNewId();
+    int const id_menu_show_full_record = wxNewId();
+    int const id_menu_record_session = wxNewId();
+    int const id_menu_replay_session = wxNewId();
     int const idDebugMenuSaveBreakpoints = wxNewId();
 
     long idMenuWatchDereference = wxNewId();
@@ -111,8 +126,14 @@ BEGIN_EVENT_TABLE(Debugger_GDB_MI, cbDebuggerPlugin)
 
     EVT_IDLE(Debugger_GDB_MI::OnIdle)
     EVT_TIMER(id_gdb_poll_timer, Debugger_GDB_MI::OnTimer)
+    EVT_THREAD(id_gdb_output_ready, Debugger_GDB_MI::OnGDBOutputReady)
 
     EVT_MENU(id_menu_info_command_stream, Debugger_GDB_MI::OnMenuInfoCommandStream)
+    EVT_MENU(id_menu_mi_performance, Debugger_GDB_MI::OnMenuMIPerformance)
+    EVT_MENU(id_menu_show_full_record, Debugger_GDB_MI::OnMenuShowFullRecord)
+    EVT_MENU(id_menu_record_session, Debugger_GDB_MI::OnMenuRecordSession)
+    EVT_UPDATE_UI(id_menu_record_session, Debugger_GDB_MI::OnUpdateRecordSession)
+    EVT_MENU(id_menu_replay_session, Debugger_GDB_MI::OnMenuReplaySession)
 END_EVENT_TABLE()
 #pragma GCC diagnostic pop
 // constructor
@@ -126,9 +147,13 @@ Debugger_GDB_MI::Debugger_GDB_MI()
        m_project(nullptr),
        m_execution_logger(this),
        m_command_stream_dialog(nullptr),
+       m_performance_window(nullptr),
+       m_full_record_dialog(nullptr),
+       m_watches_stale(false),
        m_console_pid(-1),
        m_Pid(0),
-       m_PidToAttach(0)
+       m_PidToAttach(0),
+       m_step_timing(false)
        //m_pid_to_attach(0) //(ph 2025/01/22)
 {
     // Make sure our resources are available.
@@ -191,6 +216,18 @@ void Debugger_GDB_MI::OnReleaseReal(bool appShutDown)
         m_command_stream_dialog->Destroy();
         m_command_stream_dialog = nullptr;
     }
+    if (m_performance_window)
+    {
+        m_performance_window->Destroy();
+        m_performance_window = nullptr;
+    }
+    if (m_full_record_dialog)
+    {
+        m_full_record_dialog->Destroy();
+        m_full_record_dialog = nullptr;
+    }
+    m_executor.SetRecorder(nullptr);
+    m_session_recorder.Close();
 
     EditorHooks::UnregisterHook(m_EditorHookId, true);
 }
@@ -209,6 +246,10 @@ void Debugger_GDB_MI::SetupToolsMenu(wxMenu &menu)
 // ----------------------------------------------------------------------------
 {
     menu.Append(id_menu_info_command_stream, _("Show command stream"));
+    menu.Append(id_menu_mi_performance, _("MI performance"));
+    menu.Append(id_menu_show_full_record, _("Show full record..."));
+    menu.AppendCheckItem(id_menu_record_session, _("Record MI session..."));
+    menu.Append(id_menu_replay_session, _("Replay MI session..."));
     wxMenuBar* pMnuBar = Manager::Get()->GetAppFrame()->GetMenuBar();
     int idRemoveAllBreakpoints = pMnuBar->FindMenuItem("Debug","Remove all breakpoints");
     if (wxFound(idRemoveAllBreakpoints))
@@ -332,6 +373,19 @@ void Debugger_GDB_MI::OnGDBOutput(wxCommandEvent& event)
         ParseOutput(msg);
 }
 // ----------------------------------------------------------------------------
+void Debugger_GDB_MI::OnGDBOutputReady(wxThreadEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    if (Manager::IsAppShuttingDown())
+        return; //avoid crashes
+    // The reader thread has read and parsed these lines, log them and dispatch
+    // the results right away, instead of waiting for the poll timer.
+    if (m_executor.ProcessReceivedOutput() > 0 && m_executor.HasOutput())
+        RunQueue();
+    else
+        m_actions.Run(m_executor);
+}
+// ----------------------------------------------------------------------------
 void Debugger_GDB_MI::OnAppStartShutdown(CodeBlocksEvent& event)
 // ----------------------------------------------------------------------------
 {
@@ -357,6 +411,7 @@ void Debugger_GDB_MI::OnGDBTerminated(wxCommandEvent& /*event*/)
 
     Log(_("debugger terminated!"), Logger::warning);
     m_timer_poll_debugger.Stop();
+    m_executor.ProcessReceivedOutput(); // log the last lines of GDB
     m_actions.Clear();
     m_executor.Clear();
 
@@ -399,20 +454,142 @@ void Debugger_GDB_MI::OnTimer(wxTimerEvent& /*event*/)
 void Debugger_GDB_MI::OnMenuInfoCommandStream(wxCommandEvent& /*event*/)
 // ----------------------------------------------------------------------------
 {
-    // Show collected log messages in log pane
-    wxString full;
-    for (int ii = 0; ii < m_execution_logger.GetCommandCount(); ++ii)
-        full += m_execution_logger.GetCommand(ii) + _T("\n");
+    // Show the commands sent to GDB, the list only reads the visible rows of the history
     if (m_command_stream_dialog)
+        m_command_stream_dialog->UpdateCommands();
+    else
+        m_command_stream_dialog = new dbg_mi::CommandStreamWindow(Manager::Get()->GetAppWindow(), m_execution_logger);
+    m_command_stream_dialog->Show();
+}
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::OnMenuMIPerformance(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    // Latency histograms of the commands by MI verb, they survive the debug sessions
+    if (not m_performance_window)
+        m_performance_window = new dbg_mi::PerformanceWindow(Manager::Get()->GetAppWindow(), m_executor.GetStats());
+    else
+        m_performance_window->UpdateStats();
+    m_performance_window->Show();
+}
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::OnMenuShowFullRecord(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    // The debug log cuts the long lines, they end with "see Show full record #N"
+    int last = m_execution_logger.GetLastTruncatedRecord();
+    if (last == 0)
+    {
+        cbMessageBox(_("No line of the debug log has been truncated."), _("Show full record"),
+                     wxOK | wxICON_INFORMATION, Manager::Get()->GetAppWindow());
+        return;
+    }
+    long number = wxGetNumberFromUser(_("The number of the record in the debug log"), _("Record #"),
+                                      _("Show full record"), last, 1, last, Manager::Get()->GetAppWindow());
+    if (number <= 0)
+        return;
+
+    wxString text;
+    if (not m_execution_logger.GetFullRecord(number, text))
     {
-        m_command_stream_dialog->SetText(full);
-        m_command_stream_dialog->Show();
+        cbMessageBox(wxString::Format(_("Record #%ld isn't kept anymore, only the last ones are."), number),
+                     _("Show full record"), wxOK | wxICON_INFORMATION, Manager::Get()->GetAppWindow());
+        return;
+    }
+    wxString title = wxString::Format(_T("Full record #%ld"), number);
+    if (m_full_record_dialog)
+    {
+        m_full_record_dialog->SetTitle(title);
+        m_full_record_dialog->SetText(text);
     }
     else
+        m_full_record_dialog = new dbg_mi::TextInfoWindow(Manager::Get()->GetAppWindow(), title.c_str(), text);
+    m_full_record_dialog->Show();
+}
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::OnMenuRecordSession(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    // The commands and GDB's output with their time, for "Replay MI session..."
+    if (m_session_recorder.IsRecording())
+    {
+        m_executor.SetRecorder(nullptr);
+        m_session_recorder.Close();
+        Log(wxString::Format(_("Recorded %d MI lines to %s"), m_session_recorder.GetRecordCount(),
+                             m_session_recorder.GetFilename().c_str()));
+        return;
+    }
+
+    wxFileDialog dlg(Manager::Get()->GetAppWindow(), _("Record the MI session to"), wxEmptyString,
+                     _T("session.gdbmi"), _T("MI sessions (*.gdbmi)|*.gdbmi|All files (*.*)|*.*"),
+                     wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    PlaceWindow(&dlg);
+    if (dlg.ShowModal() != wxID_OK)
+        return;
+    if (not m_session_recorder.Open(dlg.GetPath()))
     {
-        m_command_stream_dialog = new dbg_mi::TextInfoWindow(Manager::Get()->GetAppWindow(), _T("Command stream"), full);
-        m_command_stream_dialog->Show();
+        cbMessageBox(_("Can't create ") + dlg.GetPath(), _("Record MI session"), wxOK | wxICON_ERROR,
+                     Manager::Get()->GetAppWindow());
+        return;
     }
+    m_executor.SetRecorder(&m_session_recorder);
+}
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::OnUpdateRecordSession(wxUpdateUIEvent& event)
+// ----------------------------------------------------------------------------
+{
+    event.Check(m_session_recorder.IsRecording());
+}
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::OnMenuReplaySession(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    // Plays a recording back without GDB, the timings of the plugin side are shown at the end
+    wxWindow *app_window = Manager::Get()->GetAppWindow();
+    wxFileDialog dlg(app_window, _("Replay a recorded MI session"), wxEmptyString, wxEmptyString,
+                     _T("MI sessions (*.gdbmi)|*.gdbmi|All files (*.*)|*.*"), wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+    PlaceWindow(&dlg);
+    if (dlg.ShowModal() != wxID_OK)
+        return;
+
+    dbg_mi::SessionReplay replay;
+    wxString error;
+    if (not replay.Load(dlg.GetPath(), error))
+    {
+        cbMessageBox(error, _("Replay MI session"), wxOK | wxICON_ERROR, app_window);
+        return;
+    }
+    int answer = cbMessageBox(_("Replay with the recorded delays?\nNo replays at full speed."),
+                              _("Replay MI session"), wxYES_NO | wxCANCEL | wxICON_QUESTION, app_window);
+    if (answer == wxID_CANCEL)
+        return;
+
+    replay.Start(answer == wxID_YES);
+    {
+        wxProgressDialog progress(_("Replay MI session"), dlg.GetPath(), std::max(replay.GetCount(), 1), app_window,
+                                  wxPD_APP_MODAL | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+        int64_t last_update = 0;
+        while (replay.Step())
+        {
+            int64_t now = dbg_mi::CommandStats::Now();
+            if (now - last_update < 100000)
+                continue;
+            last_update = now;
+            if (not progress.Update(replay.GetPosition()))
+                break;
+        }
+    }
+
+    DebugLog(wxString::Format(_T("Replayed %d of %d lines (%d commands, %d output lines, %d notifications) ")
+                              _T("in %lld ms, the recording took %lld ms"),
+                              replay.GetPosition(), replay.GetCount(), replay.GetCommandCount(),
+                              replay.GetOutputCount(), replay.GetNotificationCount(),
+                              (long long)(replay.GetElapsed() / 1000),
+                              (long long)(replay.GetRecordedDuration() / 1000)));
+
+    dbg_mi::PerformanceWindow window(app_window, replay.GetStats());
+    window.SetTitle(_("MI performance of the replay"));
+    window.ShowModal();
 }
 // ----------------------------------------------------------------------------
 void Debugger_GDB_MI::AddStringCommand(wxString const &command)
@@ -432,7 +609,8 @@ struct Notifications
     {
     }
 
-    void operator()(dbg_mi::ResultParser const &parser)
+    // 'count' > 1 for a burst of notifications of the same class, 'parser' is the first one
+    void operator()(dbg_mi::ResultParser const &parser, int count = 1)
     {
         dbg_mi::ResultValue const &result_value = parser.GetResultValue();
         m_plugin->DebugLog(_T("notification event received!"));
@@ -445,7 +623,7 @@ struct Notifications
         else
         {
             if (parser.GetResultType() == dbg_mi::ResultParser::NotifyAsyncOutput)
-                ParseNotifyAsyncOutput(parser);
+                ParseNotifyAsyncOutput(parser, count);
             else if(parser.GetResultClass() == dbg_mi::ResultParser::ClassStopped)
             {
                 dbg_mi::StoppedReason reason = dbg_mi::StoppedReason::Parse(result_value);
@@ -456,11 +634,11 @@ struct Notifications
                     {
                         wxString signal_name, signal_meaning;
 
-                        dbg_mi::Lookup(result_value, _T("signal-name"), signal_name);
+                        dbg_mi::Lookup(result_value, dbg_mi::Atom_signal_name, signal_name);
 
                         if(signal_name != _T("SIGTRAP") && signal_name != _T("SIGINT"))
                         {
-                            dbg_mi::Lookup(result_value, _T("signal-meaning"), signal_meaning);
+                            dbg_mi::Lookup(result_value, dbg_mi::Atom_signal_meaning, signal_meaning);
                             // avoid empty signal info
                             if ( signal_name.empty())
                                 ;//avoid empty signal messages
@@ -486,7 +664,7 @@ struct Notifications
                 case dbg_mi::StoppedReason::Exited:
                     {
                         int code = -1;
-                        if(not dbg_mi::Lookup(result_value, _T("exit-code"), code))
+                        if(not dbg_mi::Lookup(result_value, dbg_mi::Atom_exit_code, code))
                             code = -1;
                         m_plugin->SetExitCode(code);
                         m_executor.Execute(wxT("-gdb-exit")); //should be -gdb-exit
@@ -499,8 +677,10 @@ struct Notifications
                         wxString frameFuncValue = wxEmptyString;
                         wxString frameFromValue = wxEmptyString;
 
-                        dbg_mi::Lookup(result_value, _T("frame.func"), frameFuncValue);
-                        dbg_mi::Lookup(result_value, _T("frame.from"), frameFromValue);
+                        static dbg_mi::KeyPath const frame_func("frame.func");
+                        static dbg_mi::KeyPath const frame_from("frame.from");
+                        dbg_mi::Lookup(result_value, frame_func, frameFuncValue);
+                        dbg_mi::Lookup(result_value, frame_from, frameFromValue);
 
                         //-Manager::Get()->GetDebuggerManager()->ShowBacktraceDialog();     //(ph 2024/03/06))
                         //-UpdateCursor(result_value, true);                                //(ph 2024/03/06)
@@ -562,7 +742,7 @@ private:
         else
         {
             dbg_mi::ResultValue const *thread_id_value;
-            thread_id_value = result_value.GetTupleValue(m_simple_mode ? _T("new-thread-id") : _T("thread-id"));
+            thread_id_value = result_value.GetTupleValue(m_simple_mode ? dbg_mi::Atom_new_thread_id : dbg_mi::Atom_thread_id);
             if(thread_id_value)
             {
                 long id;
@@ -579,6 +759,7 @@ private:
             {
                 m_plugin->GetCurrentFrame().SetPosition(frame.GetFilename(), frame.GetLine());
                 m_plugin->SyncEditor(frame.GetFilename(), frame.GetLine(), true);
+                m_plugin->LogStepLatency(_T("cursor"), false);
             }
             else
             {
@@ -591,18 +772,20 @@ private:
     }
 
     // ----------------------------------------------------------------------------
-    void ParseNotifyAsyncOutput(dbg_mi::ResultParser const &parser)
+    void ParseNotifyAsyncOutput(dbg_mi::ResultParser const &parser, int count)
     // ----------------------------------------------------------------------------
     {
         if (parser.GetAsyncNotifyType() == _T("thread-group-started"))
         {
             int pid;
-            dbg_mi::Lookup(parser.GetResultValue(), _T("pid"), pid);
+            dbg_mi::Lookup(parser.GetResultValue(), dbg_mi::Atom_pid, pid);
             m_plugin->Log(wxString::Format(_T("Found child pid: %d\n"), pid));
             dbg_mi::GDBExecutor &exec = m_plugin->GetGDBExecutor();
             if (not exec.HasChildPID())
                 exec.SetChildPID(pid);
         }
+        else if (count > 1)
+            m_plugin->Log(wxString::Format(_T("Notification: %s (%d times)\n"), parser.GetAsyncNotifyType().c_str(), count));
         else
             m_plugin->Log(wxString::Format(_T("Notification: %s\n"), parser.GetAsyncNotifyType().c_str()));
     }
@@ -617,28 +800,79 @@ private:
 void Debugger_GDB_MI::UpdateOnFrameChanged(bool wait)
 // ----------------------------------------------------------------------------
 {
-    int hasAutoUpdates = 0;                                      //(ph 2024/03/06)
-
     if(wait)
         m_actions.Add(new dbg_mi::BarrierAction);
     DebuggerManager *dbg_manager = Manager::Get()->GetDebuggerManager();
 
-    if(IsWindowReallyShown(dbg_manager->GetWatchesDialog()->GetWindow()) && !m_watches.empty())
+    if(m_watches.empty())
+        return;
+    if(not IsWindowReallyShown(dbg_manager->GetWatchesDialog()->GetWindow()))
+    {
+        // caught up by RequestUpdate(Watches) when the window is shown
+        m_watches_stale = true;
+        return;
+    }
+    m_watches_stale = false;
+
+    // Only the watches shown are refreshed, by name: the watches with "Auto Update"
+    // and their children which aren't under a collapsed node.
+    // The thawed ones are read again with their root.
+    wxArrayString names, thawed;
+    std::set<wxString> frozen;
+    for(dbg_mi::WatchesContainer::iterator it = m_watches.begin(); it != m_watches.end(); ++it)
     {
-        for(dbg_mi::WatchesContainer::iterator it = m_watches.begin(); it != m_watches.end(); ++it)
+        if((*it)->GetID().empty())
         {
-            if((*it)->GetID().empty() && !(*it)->ForTooltip())
+            if(!(*it)->ForTooltip())
                 m_actions.Add(new dbg_mi::WatchCreateAction(*it, m_watches, m_execution_logger));
+            continue;
+        }
+        FreezeHiddenWatches(*it, frozen, thawed);
+        // Skip watch updates when no watch has property "Auto Update" //(ph 2024/03/06)
+        if((*it)->IsAutoUpdateEnabled())
+            names.Add((*it)->GetID());
+    }
+    m_frozen_watches.swap(frozen);
 
-            // Skip watch updates when no watch has property "Auto Update" //(ph 2024/03/06)
-            if ( (*it)->IsAutoUpdateEnabled())
-                ++hasAutoUpdates;
+    if(not names.empty())
+        m_actions.Add(new dbg_mi::WatchesUpdateAction(m_watches, m_execution_logger, names,
+                                                      m_executor.GetInFlightLimit()));
+}
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::FreezeHiddenWatches(dbg_mi::Watch::Pointer const &watch, std::set<wxString> &frozen,
+                                          wxArrayString &thawed, bool hidden)
+// ----------------------------------------------------------------------------
+{
+    // A frozen var object isn't updated by -var-update of its parent, nor are its children.
+    // The value is read again when it's thawed and its parent is updated.
+    // Under a hidden node the frozen ones are kept as they are, they're thawed
+    // when their own parent is shown again.
+    bool shown = not hidden and watch->IsExpanded();
+    for(int ii = 0; ii < watch->GetChildCount(); ++ii)
+    {
+        dbg_mi::Watch::Pointer child = cb::static_pointer_cast<dbg_mi::Watch>(watch->GetChild(ii));
+        wxString const &id = child->GetID();
+        if(id.empty())
+            continue;
+
+        bool was_frozen = m_frozen_watches.count(id) != 0;
+        if(hidden)
+        {
+            if(was_frozen)
+                frozen.insert(id);
+        }
+        else if(not shown)
+        {
+            if(not was_frozen)
+                AddStringCommand(_T("-var-set-frozen ") + id + _T(" 1"));
+            frozen.insert(id);
         }
-        if (hasAutoUpdates)                                             //(ph 2024/03/06)
+        else if(was_frozen)
         {
-            //-m_actions.Add(new dbg_mi::BarrierAction); //wait for "done" response from remote //(ph 2024/03/06)
-            m_actions.Add(new dbg_mi::WatchesUpdateAction(m_watches, m_execution_logger));
+            AddStringCommand(_T("-var-set-frozen ") + id + _T(" 0"));
+            thawed.Add(id);
         }
+        FreezeHiddenWatches(child, frozen, thawed, not shown);
     }
 }
 // ----------------------------------------------------------------------------
@@ -672,6 +906,9 @@ void Debugger_GDB_MI::RunQueue()
 
         if(m_executor.IsStopped())
             m_actions.Run(m_executor);
+
+        if (m_step_timing && m_actions.Empty() && m_executor.IsStopped())
+            LogStepLatency(_T("updates done"), true);
     }
 }
 // ----------------------------------------------------------------------------
@@ -680,10 +917,11 @@ void Debugger_GDB_MI::ParseOutput(wxString const &str)
 {
     if(not str.IsEmpty())
     {
-        wxArrayString const &lines = GetArrayFromString(str, _T('\n'));
-        for(size_t ii = 0; ii < lines.GetCount(); ++ii)
-            m_executor.ProcessOutput(lines[ii]);
-        m_actions.Run(m_executor);
+        // the lines are framed in place, no array of lines is built
+        if (m_executor.ReceiveOutput(str) > 0 && m_executor.HasOutput())
+            RunQueue(); // dispatch now, not on the next timer tick
+        else
+            m_actions.Run(m_executor);
     }
 }
 // ----------------------------------------------------------------------------
@@ -985,9 +1223,29 @@ int Debugger_GDB_MI::LaunchDebugger(wxString const &debugger, wxString const &de
     if (ret != 0)
         return ret;
 
+    DebuggerConfiguration& active_config = GetActiveConfigEx();
+    if (active_config.GetFlag(DebuggerConfiguration::BatchCommandWrites))
+        m_executor.SetWritePolicy(dbg_mi::CommandExecutor::WriteEachRun, active_config.GetMaxCommandsPerWrite());
+    else
+        m_executor.SetWritePolicy(dbg_mi::CommandExecutor::WriteEachCommand);
+    m_executor.SetInFlightLimit(active_config.GetMaxCommandsInFlight(pTarget and IsRemoteDebugging(pTarget)));
+    m_executor.SetTimings(active_config.GetFlag(DebuggerConfiguration::EnableTimings),
+                          active_config.GetSlowCommandThreshold());
+    m_execution_logger.SetDebugLevel(active_config.GetDebugLogLevel());
+    m_execution_logger.SetMaxLineLength(active_config.GetMaxDebugLineLength());
+    m_execution_logger.SetVerbosity(active_config.GetDebugLogVerbosity());
+    // the var objects of a new GDB aren't frozen
+    m_frozen_watches.clear();
+    m_watches_stale = false;
+    m_execution_logger.SetCommandHistorySize(active_config.GetCommandHistorySize());
+
+    if (m_executor.StartOutputReader(this, id_gdb_output_ready))
+        DebugLog(_T("GDB output is read and parsed on a background thread"));
+    else
+        DebugLog(_T("GDB output is polled"));
+
 //    m_executor.Stopped(true);
     m_executor.Stopped(false);  //command execution may be too early for remotes //(ph 2024/03/06)
-//    m_executor.Execute(_T("-enable-timings"));
 
     // if remote debugging
     if ( pTarget and IsRemoteDebugging(pTarget) ) //(ph 2025/01/22)
@@ -1039,13 +1297,16 @@ int Debugger_GDB_MI::LaunchDebugger(wxString const &debugger, wxString const &de
     }
 
     //-dbg_mi::Configuration &active_config = GetActiveConfigEx(); //(ph 2024/03/11)
-    DebuggerConfiguration& active_config = GetActiveConfigEx();
 
     //-if (active_config.GetFlag(dbg_mi::Configuration::PrettyPrinters)) //(ph 2024/03/11)
     //if (active_config.GetFlag(DebuggerConfiguration::PrettyPrinters))
         //-m_actions.Add(new dbg_mi::SimpleAction(_T("-enable-pretty-printing")));                     //(ph 2024/03/06)
         m_actions.Add(new dbg_mi::SimpleAction(_T("-enable-pretty-printing"), m_execution_logger));
 
+    // queued like the other setup commands, a direct Execute may be too early for remotes
+    if (m_executor.GetTimings())
+        m_actions.Add(new dbg_mi::SimpleAction(_T("-enable-timings"), m_execution_logger));
+
     //-wxArrayString const &commands = active_config.GetInitialCommands(); //(ph 2024/03/11)
     wxArrayString const &commands = active_config.GetInitialCommands(); //(ph 2025/01/11)
     for (unsigned ii = 0; ii < commands.GetCount(); ++ii)
@@ -1105,7 +1366,7 @@ int Debugger_GDB_MI::LaunchDebugger(wxString const &debugger, wxString const &de
     m_executor.Stopped(true); // Allow command execution
     m_actions.Run(m_executor);
 
-    m_timer_poll_debugger.Start(20);
+    m_timer_poll_debugger.Start(m_executor.HasOutputReader() ? c_fallback_poll_interval : c_poll_interval);
 
     // switch to the user-defined layout for debugging
     if (m_executor.IsRunning())  //checks for m_Process exists//(ph 2025/01/24)
@@ -1175,11 +1436,25 @@ void Debugger_GDB_MI::CommitRunCommand(wxString const &command)
 // ----------------------------------------------------------------------------
 {
     m_current_frame.Reset();
+    m_step_watch.Start();
+    m_step_timing = true;
     m_actions.Add(new dbg_mi::RunAction<StopNotification>(this, command,
                                                           StopNotification(this, m_executor),
                                                           m_execution_logger)
                   );
 }
+// Logs the time since the last run command (step, next, continue..) was committed.
+// ----------------------------------------------------------------------------
+void Debugger_GDB_MI::LogStepLatency(wxString const &stage, bool done)
+// ----------------------------------------------------------------------------
+{
+    if (not m_step_timing)
+        return;
+    DebugLog(wxString::Format(_T("step latency: %s after %ld ms (%s)"), stage.c_str(), m_step_watch.Time(),
+                              m_executor.HasOutputReader() ? _T("background reader") : _T("polled")));
+    if (done)
+        m_step_timing = false;
+}
 // ----------------------------------------------------------------------------
 bool Debugger_GDB_MI::RunToCursor(const wxString& filename, int line, const wxString& /*line_text*/)
 // ----------------------------------------------------------------------------
@@ -2029,6 +2304,7 @@ void Debugger_GDB_MI::DeleteWatch(cbWatch::Pointer watch)
             Continue();
         }
     }
+    m_watches.GetIndex().Remove(*it);
     m_watches.erase(it);
 }
 
@@ -2144,6 +2420,19 @@ void Debugger_GDB_MI::ExpandWatch(cb::shared_ptr<cbWatch> watch)
         dbg_mi::Watch::Pointer real_watch = cb::static_pointer_cast<dbg_mi::Watch>(watch);
         if(not real_watch->HasBeenExpanded())
             m_actions.Add(new dbg_mi::WatchExpandedAction(*it, real_watch, m_watches, m_execution_logger));
+        else
+        {
+            // the children were frozen while collapsed, they're read again now
+            std::set<wxString> frozen;
+            wxArrayString thawed;
+            FreezeHiddenWatches(real_watch, frozen, thawed);
+            for(size_t ii = 0; ii < thawed.GetCount(); ++ii)
+                m_frozen_watches.erase(thawed[ii]);
+            m_frozen_watches.insert(frozen.begin(), frozen.end());
+            if(not thawed.empty())
+                m_actions.Add(new dbg_mi::WatchesUpdateAction(m_watches, m_execution_logger, thawed,
+                                                              m_executor.GetInFlightLimit()));
+        }
     }
 }
 
@@ -2309,6 +2598,8 @@ void Debugger_GDB_MI::RequestUpdate(DebugWindows window)
         }
     case Watches:
         {
+            if(m_watches_stale)
+                UpdateOnFrameChanged(false);
             break;
         }
     default:
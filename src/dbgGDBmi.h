@@ -20,15 +20,18 @@
 #endif
 
 //#include <memory>
+#include <set>
 #include <cbplugin.h> // for "class cbPlugin"
 #include <editor_hooks.h>
 #include <logmanager.h>
+#include <wx/stopwatch.h>
 
 #include "debuggeroptionsdlg.h"
 #include "cmd_queue.h"
 #include "definitions.h"
 //#include "events.h"
 #include "gdb_executor.h"
+#include "session_recorder.h"
 #include "remotedebugging.h"
 
 class TextCtrlLogger;
@@ -37,6 +40,8 @@ class Compiler;
 namespace dbg_mi
 {
 class Configuration;
+class CommandStreamWindow;
+class PerformanceWindow;
 } // namespace dbg_mi
 
 
@@ -190,11 +195,13 @@ class Debugger_GDB_MI : public cbDebuggerPlugin
         bool IsActionsMapEmpty(){return m_actions.Empty();}
         bool IsExecutorStopped() const {return m_executor.IsStopped();}
         bool IsExecutorRunning() const {return m_executor.IsRunning();}
+        void LogStepLatency(wxString const &stage, bool done);
 
     private:
         DECLARE_EVENT_TABLE();
 
         void OnGDBOutput(wxCommandEvent& event);
+        void OnGDBOutputReady(wxThreadEvent& event);
         void OnGDBTerminated(wxCommandEvent& event);
         void OnAppStartShutdown(CodeBlocksEvent& event);
         void OnUserClosingApp(wxCloseEvent& event);
@@ -203,6 +210,11 @@ class Debugger_GDB_MI : public cbDebuggerPlugin
         void OnIdle(wxIdleEvent& event);
 
         void OnMenuInfoCommandStream(wxCommandEvent& event);
+        void OnMenuMIPerformance(wxCommandEvent& event);
+        void OnMenuShowFullRecord(wxCommandEvent& event);
+        void OnMenuRecordSession(wxCommandEvent& event);
+        void OnUpdateRecordSession(wxUpdateUIEvent& event);
+        void OnMenuReplaySession(wxCommandEvent& event);
 
         int LaunchDebugger(wxString const &debugger, wxString const &debuggee, wxString const &args,
                            wxString const &working_dir, int pid, bool console, StartType start_type);
@@ -219,6 +231,9 @@ class Debugger_GDB_MI : public cbDebuggerPlugin
         void CommitBreakpoints(bool force);
         void CommitRunCommand(wxString const &command);
         void CommitWatches();
+        // Freezes the var objects under the collapsed watches and thaws the ones shown again
+        void FreezeHiddenWatches(dbg_mi::Watch::Pointer const &watch, std::set<wxString> &frozen,
+                                 wxArrayString &thawed, bool hidden = false);
 
         void KillConsole();
         void OnDebuggerStoppedMode(CodeBlocksEvent& event);
@@ -245,6 +260,8 @@ class Debugger_GDB_MI : public cbDebuggerPlugin
         dbg_mi::ThreadsContainer m_threads;
         dbg_mi::WatchesContainer m_watches;
         dbg_mi::MemoryRangeWatchesContainer m_memoryRanges; //(ph 2024/03/04)
+        std::set<wxString> m_frozen_watches;    // the var objects frozen because they aren't shown
+        bool m_watches_stale;                   // stopped while the watches window was hidden
 
         dbg_mi::MapWatchesToType m_mapWatchesToType;
 
@@ -254,7 +271,10 @@ class Debugger_GDB_MI : public cbDebuggerPlugin
 
         wxString m_watchToAddSymbol;
 
-        dbg_mi::TextInfoWindow *m_command_stream_dialog;
+        dbg_mi::CommandStreamWindow *m_command_stream_dialog;
+        dbg_mi::PerformanceWindow *m_performance_window;
+        dbg_mi::TextInfoWindow *m_full_record_dialog;
+        dbg_mi::SessionRecorder m_session_recorder;
 
         dbg_mi::CurrentFrame m_current_frame;
         int m_exit_code;
@@ -262,6 +282,8 @@ class Debugger_GDB_MI : public cbDebuggerPlugin
         int m_Pid;
         int m_PidToAttach; //(ph 2025/01/24)
         bool m_hasStartUpError;
+        bool m_step_timing;     // a run command is timed with m_step_watch
+        wxStopWatch m_step_watch;
         cbProject* m_currentActiveProject;
         bool m_bAppStartShutdown;
 
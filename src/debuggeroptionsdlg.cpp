@@ -162,6 +162,10 @@ bool DebuggerConfiguration::GetFlag(Flags flag)
             return m_config.ReadBool(wxT("add_other_search_dirs"), false);
         case DoNotRun:
             return m_config.ReadBool(wxT("do_not_run"), false);
+        case BatchCommandWrites:
+            return m_config.ReadBool(wxT("batch_command_writes"), true);
+        case EnableTimings:
+            return m_config.ReadBool(wxT("enable_timings"), false);
         default:
             return false;
     }
@@ -193,6 +197,12 @@ void DebuggerConfiguration::SetFlag(Flags flag, bool value)
         case DoNotRun:
             m_config.Write(wxT("do_not_run"), value);
             break;
+        case BatchCommandWrites:
+            m_config.Write(wxT("batch_command_writes"), value);
+            break;
+        case EnableTimings:
+            m_config.Write(wxT("enable_timings"), value);
+            break;
         default:
             ;
     }
@@ -205,6 +215,64 @@ bool DebuggerConfiguration::IsGDB()
     return m_config.ReadInt(wxT("type"), 0) == 0;
 }
 
+// ----------------------------------------------------------------------------
+int DebuggerConfiguration::GetMaxCommandsPerWrite()
+// ----------------------------------------------------------------------------
+{
+    return m_config.ReadInt(wxT("max_commands_per_write"), 64);
+}
+
+// 0 is no limit; a remote link gets a window so the interactive commands don't wait
+// behind a long queue of refreshes
+// ----------------------------------------------------------------------------
+int DebuggerConfiguration::GetMaxCommandsInFlight(bool remote)
+// ----------------------------------------------------------------------------
+{
+    if (remote)
+        return m_config.ReadInt(wxT("max_commands_in_flight_remote"), 8);
+    return m_config.ReadInt(wxT("max_commands_in_flight"), 0);
+}
+
+// with -enable-timings the commands which take longer in GDB are logged
+// ----------------------------------------------------------------------------
+int DebuggerConfiguration::GetSlowCommandThreshold()
+// ----------------------------------------------------------------------------
+{
+    return m_config.ReadInt(wxT("slow_command_ms"), 250);
+}
+
+// dbg_mi::LogPaneLogger::DebugLevel, everything by default
+// ----------------------------------------------------------------------------
+int DebuggerConfiguration::GetDebugLogLevel()
+// ----------------------------------------------------------------------------
+{
+    return m_config.ReadInt(wxT("debug_log_level"), 4);
+}
+
+// longer lines are cut in the debug log, 0 is no limit
+// ----------------------------------------------------------------------------
+int DebuggerConfiguration::GetMaxDebugLineLength()
+// ----------------------------------------------------------------------------
+{
+    return m_config.ReadInt(wxT("debug_log_max_line"), 4096);
+}
+
+// the verbosity of the actions' debug lines by category, see dbg_mi::LogPaneLogger::SetVerbosity
+// ----------------------------------------------------------------------------
+wxString DebuggerConfiguration::GetDebugLogVerbosity()
+// ----------------------------------------------------------------------------
+{
+    return m_config.Read(wxT("debug_log_verbosity"), wxEmptyString);
+}
+
+// the commands kept in memory for the command stream, the older ones go to a journal file
+// ----------------------------------------------------------------------------
+int DebuggerConfiguration::GetCommandHistorySize()
+// ----------------------------------------------------------------------------
+{
+    return m_config.ReadInt(wxT("command_history_size"), 10000);
+}
+
 // ----------------------------------------------------------------------------
 wxString DebuggerConfiguration::GetDebuggerExecutable(bool expandMacro)
 // ----------------------------------------------------------------------------
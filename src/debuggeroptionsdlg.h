@@ -27,7 +27,9 @@ class DebuggerConfiguration : public cbDebuggerConfiguration
             CatchExceptions,
             EvalExpression,
             AddOtherProjectDirs,
-            DoNotRun
+            DoNotRun,
+            BatchCommandWrites,
+            EnableTimings
         };
 
         bool GetFlag(Flags flag);
@@ -36,6 +38,13 @@ class DebuggerConfiguration : public cbDebuggerConfiguration
         wxString GetDebuggerExecutable(bool expandMacro = true);
         wxString GetUserArguments(bool expandMacro = true);
         wxString GetDisassemblyFlavorCommand();
+        int GetMaxCommandsPerWrite();
+        int GetMaxCommandsInFlight(bool remote);
+        int GetSlowCommandThreshold();
+        int GetDebugLogLevel();
+        int GetMaxDebugLineLength();
+        wxString GetDebugLogVerbosity();
+        int GetCommandHistorySize();
         wxString GetInitCommands();
         wxArrayString const& GetInitialCommands(); //(ph 2024/03/11)
 
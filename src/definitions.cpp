@@ -100,44 +100,89 @@ bool Breakpoint::IsTemporary() const
 }
 
 // ----------------------------------------------------------------------------
-Watch::Pointer FindWatch(wxString const &expression, WatchesContainer &watches)
+size_t VarObjectIndex::IDHash::operator()(wxString const &id) const
 // ----------------------------------------------------------------------------
 {
-    for(WatchesContainer::iterator it = watches.begin(); it != watches.end(); ++it)
+    // FNV-1a, the names of the var objects are short
+    size_t hash = 2166136261u;
+    for(wxString::const_iterator it = id.begin(); it != id.end(); ++it)
     {
-        if(expression.StartsWith(it->get()->GetID()))
-        {
-            if(expression.length() == it->get()->GetID().length())
-                return *it;
-            else
-            {
-                Watch::Pointer curr = *it;
-                while(curr)
-                {
-                    Watch::Pointer temp = curr;
-                    curr = Watch::Pointer();
-
-                    for(int child = 0; child < temp->GetChildCount(); ++child)
-                    {
-                        Watch::Pointer p = cb::static_pointer_cast<Watch>(temp->GetChild(child));
-                        if(expression.StartsWith(p->GetID()))
-                        {
-                            if(expression.length() == p->GetID().length())
-                                return p;
-                            else
-                            {
-                                curr = p;
-                                break;
-                            }
-                        }
-                    }
-                }
-                if(curr)
-                    return curr;
-            }
-        }
+        hash ^= static_cast<size_t>(static_cast<wxChar>(*it));
+        hash *= 16777619u;
     }
-    return Watch::Pointer();
+    return hash;
+}
+// ----------------------------------------------------------------------------
+void VarObjectIndex::Add(Watch::Pointer const &watch)
+// ----------------------------------------------------------------------------
+{
+    if(watch and not watch->GetID().empty())
+        m_watches[watch->GetID()] = watch;
+}
+// ----------------------------------------------------------------------------
+void VarObjectIndex::Remove(Watch::Pointer const &watch)
+// ----------------------------------------------------------------------------
+{
+    RemoveChildren(watch);
+    Map::iterator it = m_watches.find(watch->GetID());
+    if(it != m_watches.end() and it->second.lock() == watch)
+        m_watches.erase(it);
+}
+// ----------------------------------------------------------------------------
+void VarObjectIndex::RemoveChildren(Watch::Pointer const &watch)
+// ----------------------------------------------------------------------------
+{
+    for(int child = 0; child < watch->GetChildCount(); ++child)
+        Remove(cb::static_pointer_cast<Watch>(watch->GetChild(child)));
+}
+// ----------------------------------------------------------------------------
+void VarObjectIndex::RemoveMarkedChildren(Watch::Pointer const &watch)
+// ----------------------------------------------------------------------------
+{
+    for(int child = 0; child < watch->GetChildCount(); ++child)
+    {
+        Watch::Pointer p = cb::static_pointer_cast<Watch>(watch->GetChild(child));
+        if(p->IsRemoved())
+            Remove(p);
+    }
+}
+// ----------------------------------------------------------------------------
+Watch::Pointer VarObjectIndex::Find(wxString const &id)
+// ----------------------------------------------------------------------------
+{
+    Map::iterator it = m_watches.find(id);
+    if(it == m_watches.end())
+        return Watch::Pointer();
+
+    Watch::Pointer watch = it->second.lock();
+    if(not watch or watch->GetID() != id)
+    {
+        // the watch was deleted or got another var object
+        m_watches.erase(it);
+        return Watch::Pointer();
+    }
+    return watch;
+}
+
+// ----------------------------------------------------------------------------
+Watch::Pointer FindWatch(wxString const &expression, WatchesContainer &watches)
+// ----------------------------------------------------------------------------
+{
+    return watches.GetIndex().Find(expression);
+}
+// ----------------------------------------------------------------------------
+void RemoveWatchChildren(Watch::Pointer const &watch, WatchesContainer &watches)
+// ----------------------------------------------------------------------------
+{
+    watches.GetIndex().RemoveChildren(watch);
+    watch->RemoveChildren();
+}
+// ----------------------------------------------------------------------------
+void RemoveMarkedWatchChildren(Watch::Pointer const &watch, WatchesContainer &watches)
+// ----------------------------------------------------------------------------
+{
+    watches.GetIndex().RemoveMarkedChildren(watch);
+    watch->RemoveMarkedChildren();
 }
 // ----------------------------------------------------------------------------
 void Watch::SetSymbol(const wxString& symbol)
@@ -265,7 +265,40 @@ class GDBMemoryRangeWatch  : public cbWatch
         bool m_ValueErrorMessage;
 };
 
-typedef std::vector<dbg_mi::Watch::Pointer> WatchesContainer;
+// The watches and their children by the name of their GDB var object, the results of
+// -var-update and -var-list-children find them without walking the trees.
+// The watches are held weakly, a watch which is gone or has a new var object isn't found.
+// ----------------------------------------------------------------------------
+class VarObjectIndex
+// ----------------------------------------------------------------------------
+{
+public:
+    void Add(Watch::Pointer const &watch);
+    // removes the watch and its children
+    void Remove(Watch::Pointer const &watch);
+    void RemoveChildren(Watch::Pointer const &watch);
+    void RemoveMarkedChildren(Watch::Pointer const &watch);
+    Watch::Pointer Find(wxString const &id);
+    void Clear() { m_watches.clear(); }
+private:
+    struct IDHash
+    {
+        size_t operator()(wxString const &id) const;
+    };
+    typedef std::unordered_map<wxString, std::weak_ptr<Watch>, IDHash> Map;
+    Map m_watches;
+};
+
+// The watches of the plugin with the index of their var objects
+// ----------------------------------------------------------------------------
+class WatchesContainer : public std::vector<dbg_mi::Watch::Pointer>
+// ----------------------------------------------------------------------------
+{
+public:
+    VarObjectIndex& GetIndex() { return m_index; }
+private:
+    VarObjectIndex m_index;
+};
 typedef std::vector<cb::shared_ptr<GDBMemoryRangeWatch>> MemoryRangeWatchesContainer; //(ph 2024/03/04)
 
 // ----------------------------------------------------------------------------
@@ -282,6 +315,9 @@ wxString CleanStringValue(wxString value);
 
 
 Watch::Pointer FindWatch(wxString const &expression, WatchesContainer &watches);
+// The children are removed from the watch and from the index of the container
+void RemoveWatchChildren(Watch::Pointer const &watch, WatchesContainer &watches);
+void RemoveMarkedWatchChildren(Watch::Pointer const &watch, WatchesContainer &watches);
 
 // Custom window to display output of DebuggerInfoCmd
 // ----------------------------------------------------------------------------
@@ -0,0 +1,91 @@
+#ifndef _DEBUGGER_MI_DIAGNOSTICS_H_
+#define _DEBUGGER_MI_DIAGNOSTICS_H_
+
+#include <wx/string.h>
+
+#include "cmd_queue.h"
+
+namespace dbg_mi
+{
+
+// The producers of the debug strings, Diagnostic calls them only for the lines it logs.
+// ResultValue, ResultParser and UpdatedVariable have a MakeDebugString().
+template<typename Producer>
+inline wxString MakeDebugString(Producer const &producer)
+{
+    return producer.MakeDebugString();
+}
+
+// A debug line of the log, built only if its category is verbose enough:
+//   Diagnostic(m_logger, Logger::Category::Watches, Logger::Verbosity::Trace)
+//       << _T("children of ") << id << _T(": ") << result;
+// The operands which aren't text are converted when they're appended, a dump of
+// a whole result costs nothing while its category isn't traced. The line goes
+// to the logger at the end of the statement.
+// ----------------------------------------------------------------------------
+class Diagnostic
+// ----------------------------------------------------------------------------
+{
+    Diagnostic(Diagnostic const &);
+    Diagnostic& operator =(Diagnostic const &);
+public:
+    Diagnostic(Logger &logger, Logger::Category::Type category,
+               Logger::Verbosity::Type verbosity = Logger::Verbosity::Normal) :
+        m_logger(logger),
+        m_enabled(logger.IsDebugEnabled(category, verbosity))
+    {
+    }
+    ~Diagnostic()
+    {
+        if(m_enabled)
+            m_logger.Debug(m_line);
+    }
+
+    bool IsEnabled() const { return m_enabled; }
+
+    Diagnostic& operator <<(wxString const &text)
+    {
+        if(m_enabled)
+            m_line += text;
+        return *this;
+    }
+    Diagnostic& operator <<(wxChar const *text)
+    {
+        if(m_enabled)
+            m_line += text;
+        return *this;
+    }
+    Diagnostic& operator <<(int value)
+    {
+        if(m_enabled)
+            m_line << value;
+        return *this;
+    }
+    Diagnostic& operator <<(long value)
+    {
+        if(m_enabled)
+            m_line << value;
+        return *this;
+    }
+    Diagnostic& operator <<(CommandID const &id)
+    {
+        if(m_enabled)
+            m_line += id.ToString();
+        return *this;
+    }
+    template<typename Producer>
+    Diagnostic& operator <<(Producer const &producer)
+    {
+        if(m_enabled)
+            m_line += MakeDebugString(producer);
+        return *this;
+    }
+private:
+    Logger &m_logger;
+    wxString m_line;
+    bool m_enabled;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_DIAGNOSTICS_H_
@@ -1,5 +1,7 @@
 #include "escape.h"
 
+#include <cstring>
+
 namespace dbg_mi
 {
 
@@ -48,4 +50,57 @@ void ConvertDirectory(wxString& str, wxString base, bool relative)
     str = EscapePath(str);
 }
 
+// ----------------------------------------------------------------------------
+int UnescapeCString(char const *src, int length, char *dest)
+// ----------------------------------------------------------------------------
+{
+    char const *end = src + length;
+    char *out = dest;
+    while (src < end)
+    {
+        // copy the plain run up to the next escape in one go
+        char const *backslash = static_cast<char const*>(std::memchr(src, '\\', end - src));
+        char const *run_end = backslash ? backslash : end;
+        if (out != src)
+            std::memmove(out, src, run_end - src);
+        out += run_end - src;
+        if (not backslash)
+            break;
+
+        src = backslash + 1;
+        if (src == end)
+        {
+            *out++ = '\\';
+            break;
+        }
+
+        char c = *src++;
+        switch (c)
+        {
+        case 'n': *out++ = '\n'; break;
+        case 't': *out++ = '\t'; break;
+        case 'r': *out++ = '\r'; break;
+        case 'a': *out++ = '\a'; break;
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'v': *out++ = '\v'; break;
+        case 'e': *out++ = '\033'; break;
+        case '0': case '1': case '2': case '3':
+        case '4': case '5': case '6': case '7':
+            {
+                // up to three octal digits, a single byte
+                int value = c - '0';
+                for (int digits = 1; digits < 3 && src < end && *src >= '0' && *src <= '7'; ++digits)
+                    value = value * 8 + (*src++ - '0');
+                *out++ = static_cast<char>(value);
+            }
+            break;
+        default:
+            // \" \\ and anything unknown stand for the char itself
+            *out++ = c;
+        }
+    }
+    return out - dest;
+}
+
 } // namespace dbg_mi
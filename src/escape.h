@@ -9,6 +9,11 @@ namespace dbg_mi
 wxString EscapePath(wxString const &path);
 void ConvertDirectory(wxString& str, wxString base, bool relative);
 
+// Decodes the escape sequences of a MI c-string (the text between the quotes) in one pass:
+// \" \\ \n \t \r \a \b \f \v \e and octal bytes. The decoded string is never longer,
+// so 'dest' can be 'src' itself. Returns the decoded length in bytes.
+int UnescapeCString(char const *src, int length, char *dest);
+
 } // namespace dbg_mi
 
 #endif // _DEBUGGER_MI_ESCAPE_H_
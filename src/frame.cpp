@@ -1,6 +1,7 @@
 #include "frame.h"
 
 #include "cmd_result_parser.h"
+#include "cmd_result_schema.h"
 
 namespace dbg_mi
 {
@@ -10,55 +11,49 @@ bool Frame::ParseOutput(ResultValue const &output_value)
     if(output_value.GetType() != ResultValue::Tuple)
         return false;
 
-    dbg_mi::ResultValue const *frame_value = output_value.GetTupleValue(_T("frame"));
+    dbg_mi::ResultValue const *frame_value = output_value.GetTupleValue(Atom_frame);
     if(not frame_value)
         return false;
     return ParseFrame(*frame_value);
 }
 
-bool Frame::ParseFrame(ResultValue const &frame_value)
+RecordSchema<Frame> const & Frame::GetSchema()
 {
-    ResultValue const *function = frame_value.GetTupleValue(_T("func"));
-    if(function)
-        m_function = function->GetSimpleValue();
-    ResultValue const *address = frame_value.GetTupleValue(_T("addr"));
-    if(address)
+    static RecordSchema<Frame>::Field const fields[] =
     {
-        wxString const &str = address->GetSimpleValue();
-        //if(not str.ToULong(&m_address, 16)) //(ph 2024/03/11)
-        if(not str.ToULongLong(&m_address, 16)) //(ph 2024/03/11)
-            return false;
-    }
+        DBG_MI_RECORD_FIELD(Frame, func,        m_function,         ConvertString),
+        DBG_MI_RECORD_FIELD(Frame, addr,        m_address,          ConvertAddress),
+        DBG_MI_RECORD_FIELD(Frame, from,        m_from,             ConvertString),
+        DBG_MI_RECORD_FIELD(Frame, line,        m_line,             ConvertInt),
+        DBG_MI_RECORD_FIELD(Frame, file,        m_filename,         ConvertString),
+        DBG_MI_RECORD_FIELD(Frame, fullname,    m_full_filename,    ConvertString)
+    };
+    static RecordSchema<Frame> const schema(fields);
+    return schema;
+}
 
-    ResultValue const *from = frame_value.GetTupleValue(_T("from"));
-    if(from)
-        m_from = from->GetSimpleValue();
+bool Frame::ParseFrame(ResultValue const &frame_value)
+{
+    return Complete(GetSchema().Decode(frame_value, *this));
+}
 
-    ResultValue const *line = frame_value.GetTupleValue(_T("line"));
-    ResultValue const *filename = frame_value.GetTupleValue(_T("file"));
-    ResultValue const *full_filename = frame_value.GetTupleValue(_T("fullname"));
+bool Frame::Complete(DecodedFields const &fields)
+{
+    //if(not str.ToULong(&m_address, 16)) //(ph 2024/03/11)
+    if(fields.IsInvalid(Atom_addr))
+        return false;
 
-    if(not line && !filename && !full_filename)
+    if(not fields.Found(Atom_line) && !fields.Found(Atom_file) && !fields.Found(Atom_fullname))
     {
         m_has_valid_source = false;
         return true;
     }
-    if((not line || line->GetType() != ResultValue::Simple)
-       || (not filename || filename->GetType() != ResultValue::Simple)
-       || (not full_filename || full_filename->GetType() != ResultValue::Simple))
-    {
+    if(not fields.Has(Atom_line) || !fields.Has(Atom_file) || !fields.Has(Atom_fullname))
         return false;
-    }
 
     //m_filename = filename->GetSimpleValue();
     // use full_filename, else double-click on frame will get wrong file
-    m_filename = full_filename->GetSimpleValue();
-    m_full_filename = full_filename->GetSimpleValue();
-    long long_line;
-    if(not line->GetSimpleValue().ToLong(&long_line))
-        return false;
-
-    m_line = long_line;
+    m_filename = m_full_filename;
     m_has_valid_source = true;
 
     return true;
@@ -74,7 +69,7 @@ bool FrameArguments::Attach(ResultValue const &output)
     if(output.GetType() != ResultValue::Tuple)
         return false;
 
-    m_stack_args = output.GetTupleValue(_T("stack-args"));
+    m_stack_args = output.GetTupleValue(Atom_stack_args);
     return m_stack_args;
 }
 
@@ -96,7 +91,7 @@ bool FrameArguments::ParseFrame(ResultValue const &frame_value, wxString &args)
 {
     args = wxEmptyString;
 
-    ResultValue const *args_tuple = frame_value.GetTupleValue(_T("args"));
+    ResultValue const *args_tuple = frame_value.GetTupleValue(Atom_args);
     if(not args_tuple || args_tuple->GetType() != ResultValue::Array)
         return false;
 
@@ -105,8 +100,8 @@ bool FrameArguments::ParseFrame(ResultValue const &frame_value, wxString &args)
         ResultValue const *arg = args_tuple->GetTupleValueByIndex(ii);
         assert(arg);
 
-        ResultValue const *name = arg->GetTupleValue(_T("name"));
-        ResultValue const *value = arg->GetTupleValue(_T("value"));
+        ResultValue const *name = arg->GetTupleValue(Atom_name);
+        ResultValue const *value = arg->GetTupleValue(Atom_value);
 
         if(name && name->GetType() == ResultValue::Simple
            && value && value->GetType() == ResultValue::Simple)
@@ -128,7 +123,7 @@ StoppedReason StoppedReason::Parse(ResultValue const &value)
     //-ResultValue const *reason = value.GetTupleValue(_T("reason")); //causes assert //(ph 2025/01/22)
     ResultValue const *reason = nullptr;
     wxString reasonStr = wxString();
-    if (value.GetType() == value.Tuple) reason = value.GetTupleValue(_T("reason"));
+    if (value.GetType() == value.Tuple) reason = value.GetTupleValue(Atom_reason);
     if (value.GetType() == value.Simple) reasonStr = value.GetSimpleValue();
     if(not (reason or reasonStr.Length()))
         return Unknown;
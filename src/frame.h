@@ -7,6 +7,8 @@ namespace dbg_mi
 {
 
 class ResultValue;
+struct DecodedFields;
+template<typename Record> class RecordSchema;
 
 class Frame
 {
@@ -20,6 +22,10 @@ public:
 
     bool ParseOutput(ResultValue const &output_value);
     bool ParseFrame(ResultValue const &output_value);
+    // Checks the fields decoded with GetSchema() and completes the frame.
+    bool Complete(DecodedFields const &fields);
+
+    static RecordSchema<Frame> const & GetSchema();
 
     int GetLine() const { return m_line; }
     wxString const & GetFilename() const { return m_filename; }
@@ -1,6 +1,13 @@
 #include "gdb_executor.h"
 
+#include <atomic>
 #include <cassert>
+#include <cerrno>
+
+#ifndef __WXMSW__
+    #include <poll.h>
+    #include <unistd.h>
+#endif
 
 #include <sdk.h>
 #include <cbproject.h>
@@ -12,8 +19,13 @@
 #include <compiler.h>
 #include <compilerfactory.h>
 #include <pipedprocess.h>
+#include <wx/log.h>
+#include <wx/thread.h>
+#include <wx/tokenzr.h>
+#include <wx/wfstream.h>
 
 #include "helpers.h"
+#include "spsc_queue.h"
 
 namespace
 {
@@ -147,7 +159,171 @@ void GetChildPIDs(int parent, std::vector<int> &childs)
 namespace dbg_mi
 {
 
+// PipedProcess reads the rest of the pipes when GDB exits and then closes them. While the
+// reader thread runs it has its own copies of the pipes and reads them alone.
+class GDBProcess : public PipedProcess
+{
+public:
+    GDBProcess(PipedProcess **pvThis, wxEvtHandler *parent, int id, wxString const &cwd) :
+        PipedProcess(pvThis, parent, id, true, cwd),
+        m_reader_active(false)
+    {
+    }
+
+    void SetReaderActive(bool active) { m_reader_active = active; }
+    virtual bool HasInput() { return not m_reader_active && PipedProcess::HasInput(); }
+private:
+    bool m_reader_active;
+};
+
+// Reads the pipes of GDB, frames the lines and parses the records off the GUI thread.
+// The decoded lines go to the GUI thread through a lock-free queue; one event is sent
+// per batch and no other until the GUI thread has drained the queue (ProcessReceivedOutput).
+class OutputReader : public wxThread
+{
+public:
+    typedef SpscQueue<CommandExecutor::OutputLine> Queue;
+
+    OutputReader(int fd_out, int fd_err, wxEvtHandler *event_handler, int id) :
+        wxThread(wxTHREAD_JOINABLE),
+        m_event_handler(event_handler),
+        m_id(id),
+        m_fd_out(fd_out),
+        m_fd_err(fd_err),
+        m_wake_pending(false)
+    {
+        m_closed[0].store(c_open);
+        m_closed[1].store(c_open);
+    }
+    // the fds are owned by the reader, they are closed after the thread is joined
+    ~OutputReader()
+    {
+        while(CommandExecutor::OutputLine *line = m_queue.Pop())
+            delete line;
+#ifndef __WXMSW__
+        if(m_fd_out >= 0)
+            close(m_fd_out);
+        if(m_fd_err >= 0)
+            close(m_fd_err);
+#endif
+    }
+
+    // called on the GUI thread before the queue is drained
+    void ClearWakePending() { m_wake_pending.store(false, std::memory_order_release); }
+    CommandExecutor::OutputLine* Pop() { return m_queue.Pop(); }
+    // Once a pipe is closed: 0 at its end, an errno after a read error; else c_open.
+    // It's reported once, after that it's c_open again.
+    int TakeClosed(int pipe) { return m_closed[pipe].exchange(c_open, std::memory_order_acq_rel); }
+
+    static int const c_open = -1;
+protected:
+    virtual ExitCode Entry()
+    {
+#ifndef __WXMSW__
+        pollfd fds[2];
+        fds[0].fd = m_fd_out;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_fd_err;
+        fds[1].events = POLLIN;
+        LineFramer framers[2];
+        char buffer[16 * 1024];
+
+        while(not TestDestroy() && (fds[0].fd >= 0 || fds[1].fd >= 0))
+        {
+            // the timeout only bounds the wait for Delete()
+            int result = poll(fds, 2, 100);
+            if(result < 0 && errno != EINTR)
+                break;
+            if(result <= 0)
+                continue;
+
+            bool closed = false;
+            for(int ii = 0; ii < 2; ++ii)
+            {
+                if(fds[ii].fd < 0 || not (fds[ii].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+                ssize_t count = read(fds[ii].fd, buffer, sizeof(buffer));
+                // the wx pipes may be non-blocking, there was nothing to read after all
+                if(count < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+                    continue;
+                if(count <= 0)
+                {
+                    // the end of the pipe or a real error, the GUI thread logs it
+                    m_closed[ii].store(count == 0 ? 0 : errno, std::memory_order_release);
+                    fds[ii].fd = -1; // closed, poll ignores negative fds
+                    framers[ii].Append("\n", 1); // the last line may have no line end
+                    closed = true;
+                }
+                else
+                    framers[ii].Append(buffer, count);
+                Span line;
+                while(framers[ii].Next(line))
+                {
+                    if(not Push(line))
+                        return 0;
+                }
+            }
+            Wake(closed);
+        }
+#endif
+        return 0;
+    }
+private:
+    bool Push(Span const &line)
+    {
+        CommandExecutor::OutputLine *output = new CommandExecutor::OutputLine;
+        CommandExecutor::DecodeOutput(line.data, line.length, *output, true);
+        while(not m_queue.Push(output))
+        {
+            // the GUI thread is behind, let it catch up
+            Wake();
+            if(TestDestroy())
+            {
+                delete output;
+                return false;
+            }
+            wxMilliSleep(1);
+        }
+        return true;
+    }
+    void Wake(bool closed = false)
+    {
+        if((m_queue.Empty() && not closed) || m_wake_pending.exchange(true, std::memory_order_acq_rel))
+            return;
+        wxQueueEvent(m_event_handler, new wxThreadEvent(wxEVT_THREAD, m_id));
+    }
+private:
+    wxEvtHandler *m_event_handler;
+    Queue m_queue;
+    int m_id;
+    int m_fd_out, m_fd_err;
+    std::atomic<int> m_closed[2];
+    std::atomic<bool> m_wake_pending;
+};
+
+// ----------------------------------------------------------------------------
+LogPaneLogger::LogPaneLogger(cbDebuggerPlugin *plugin) :
+// ----------------------------------------------------------------------------
+    m_plugin(plugin),
+    m_shutdowned(false),
+    m_flush_timer(*this),
+    m_debug_level(DebugAll),
+    m_max_line_length(0),
+    m_truncated_records(0)
+{
+    for (int ii = 0; ii < Category::Count; ++ii)
+        m_verbosity[ii] = Verbosity::Normal;
+}
+// ----------------------------------------------------------------------------
+LogPaneLogger::~LogPaneLogger()
+// ----------------------------------------------------------------------------
+{
+    m_flush_timer.Stop();
+    DiscardRecords();
+}
+// ----------------------------------------------------------------------------
 void LogPaneLogger::Log(wxString const &line, Log::Type type)
+// ----------------------------------------------------------------------------
 {
     if (m_shutdowned)
         return;
@@ -234,33 +410,191 @@ The following is a preliminary list of possible out-of-band records.
 void LogPaneLogger::Debug(wxString const &line, Line::Type type)
 // ----------------------------------------------------------------------------
 {
-    if (m_shutdowned)
+    if (m_shutdowned or not IsDebugEnabled(type))
         return;
 
-    ::Logger::level cmdLevel  = ::Logger::warning;  //use the blue color
-    ::Logger::level cmdResult = ::Logger::warning;  //use the black color
+    m_records.push_back(Record());
+    Record &record = m_records.back();
+    record.type = type;
+    if (m_max_line_length > 0 and static_cast<int>(line.length()) > m_max_line_length)
+    {
+        // the pane stays responsive with multi-megabyte records
+        int number = ++m_truncated_records;
+        m_full_records.push_back(std::make_pair(number, line));
+        if (m_full_records.size() > c_kept_full_records)
+            m_full_records.pop_front();
+        record.line = line.Left(m_max_line_length);
+        record.line += wxString::Format(_T(" ... [%lu more chars, see Show full record #%d]"),
+                                        static_cast<unsigned long>(line.length() - m_max_line_length),
+                                        number);
+    }
+    else
+        record.line = line;
 
+    if (m_records.size() >= c_max_records)
+        Flush();
+    else if (not m_flush_timer.IsRunning())
+        m_flush_timer.Start(c_flush_interval, wxTIMER_ONE_SHOT);
+}
+// ----------------------------------------------------------------------------
+bool LogPaneLogger::IsDebugEnabled(Line::Type type) const
+// ----------------------------------------------------------------------------
+{
+    return GetDebugLevel(type) <= m_debug_level and m_plugin->HasDebugLog();
+}
+// ----------------------------------------------------------------------------
+void LogPaneLogger::SetVerbosity(wxString const &spec)
+// ----------------------------------------------------------------------------
+{
+    static wxChar const * const category_names[Category::Count] =
+    {
+        _T("breakpoints"), _T("backtrace"), _T("threads"), _T("watches"),
+        _T("registers"), _T("disassembly"), _T("memory"), _T("run")
+    };
+    static wxChar const * const verbosity_names[] = { _T("quiet"), _T("normal"), _T("trace") };
+
+    for (int ii = 0; ii < Category::Count; ++ii)
+        m_verbosity[ii] = Verbosity::Normal;
+
+    wxStringTokenizer tokens(spec, _T(",; "), wxTOKEN_STRTOK);
+    while (tokens.HasMoreTokens())
+    {
+        wxString token = tokens.GetNextToken().Lower();
+        wxString name = token.BeforeFirst(_T('='));
+        wxString value = token.AfterFirst(_T('='));
+
+        int verbosity = -1;
+        for (int ii = 0; ii <= Verbosity::Trace; ++ii)
+        {
+            if (value == verbosity_names[ii])
+                verbosity = ii;
+        }
+        if (verbosity < 0)
+        {
+            Debug(_T("unknown debug log verbosity: ") + token);
+            continue;
+        }
+
+        bool found = false;
+        for (int ii = 0; ii < Category::Count; ++ii)
+        {
+            if (name == _T("all") or name == category_names[ii])
+            {
+                m_verbosity[ii] = static_cast<Verbosity::Type>(verbosity);
+                found = true;
+            }
+        }
+        if (not found)
+            Debug(_T("unknown debug log category: ") + token);
+    }
+}
+// ----------------------------------------------------------------------------
+int LogPaneLogger::GetDebugLevel(Line::Type type)
+// ----------------------------------------------------------------------------
+{
     switch (type)
     {
-        case Line::Debug:
-            m_plugin->DebugLog(line, ::Logger::info);
-            break;
-        case Line::Unknown:
-            m_plugin->DebugLog(line, ::Logger::info);
-            break;
+        case Line::Error:
+        case Line::ProgramState:
+            return DebugErrors;
         case Line::Command:
-            m_plugin->DebugLog(line, cmdLevel); //blue  //(ph 2024/04/12)
-            break;
+            return DebugCommands;
         case Line::CommandResult:
-            m_plugin->DebugLog(line, cmdResult); //blue = //(ph 2024/04/12)
-            break;
-        case Line::ProgramState:
-            m_plugin->DebugLog(line, ::Logger::critical);
-            break;
-        case Line::Error:
-            m_plugin->DebugLog(line, ::Logger::error); //red & //(ph 2024/04/12)
-            break;
+        case Line::Unknown:
+            return DebugOutput;
+        case Line::Debug:
+        default:
+            return DebugAll;
+    }
+}
+// ----------------------------------------------------------------------------
+static ::Logger::level GetLogLevel(Logger::Line::Type type)
+// ----------------------------------------------------------------------------
+{
+    switch (type)
+    {
+        case Logger::Line::Command:
+            return ::Logger::warning;   //blue  //(ph 2024/04/12)
+        case Logger::Line::CommandResult:
+            return ::Logger::warning;   //black //(ph 2024/04/12)
+        case Logger::Line::ProgramState:
+            return ::Logger::critical;
+        case Logger::Line::Error:
+            return ::Logger::error;     //red   //(ph 2024/04/12)
+        case Logger::Line::Debug:
+        case Logger::Line::Unknown:
+        default:
+            return ::Logger::info;
+    }
+}
+// ----------------------------------------------------------------------------
+void LogPaneLogger::Flush()
+// ----------------------------------------------------------------------------
+{
+    if (m_shutdowned)
+    {
+        DiscardRecords();
+        return;
+    }
+
+    // the consecutive lines of a level go out as one entry
+    wxString batch;
+    ::Logger::level batch_level = ::Logger::info;
+    bool has_batch = false;
+    m_flushed_records.swap(m_records);
+    for (Records::const_iterator it = m_flushed_records.begin(); it != m_flushed_records.end(); ++it)
+    {
+        ::Logger::level level = GetLogLevel(it->type);
+        if (has_batch and level != batch_level)
+        {
+            m_plugin->DebugLog(batch, batch_level);
+            batch.clear();
+            has_batch = false;
+        }
+        if (has_batch)
+            batch += _T('\n');
+        batch += it->line;
+        batch_level = level;
+        has_batch = true;
     }
+    m_flushed_records.clear();
+    if (has_batch)
+        m_plugin->DebugLog(batch, batch_level);
+}
+// ----------------------------------------------------------------------------
+void LogPaneLogger::DiscardRecords()
+// ----------------------------------------------------------------------------
+{
+    m_records.clear();
+}
+// ----------------------------------------------------------------------------
+void LogPaneLogger::MarkAsShutdowned()
+// ----------------------------------------------------------------------------
+{
+    m_shutdowned = true;
+    m_flush_timer.Stop();
+    DiscardRecords();
+}
+// ----------------------------------------------------------------------------
+void LogPaneLogger::SetCommandHistorySize(int size)
+// ----------------------------------------------------------------------------
+{
+    if (size != m_commands.GetCapacity())
+        m_commands.SetCapacity(size);
+}
+// ----------------------------------------------------------------------------
+bool LogPaneLogger::GetFullRecord(int number, wxString &text) const
+// ----------------------------------------------------------------------------
+{
+    for (FullRecords::const_iterator it = m_full_records.begin(); it != m_full_records.end(); ++it)
+    {
+        if (it->first == number)
+        {
+            text = it->second;
+            return true;
+        }
+    }
+    return false;
 }
 
 GDBExecutor::GDBExecutor() :
@@ -268,6 +602,7 @@ GDBExecutor::GDBExecutor() :
     m_pid(-1),
     m_child_pid(-1),
     m_attached_pid(-1),
+    m_output_reader(NULL),
     m_stopped(true),
     m_interupting(false),
     m_temporary_interupt(false)
@@ -277,6 +612,7 @@ GDBExecutor::GDBExecutor() :
 
 GDBExecutor::~GDBExecutor()
 {
+    StopOutputReader();
     FreeDebuggingFuncs();
 }
 
@@ -287,7 +623,7 @@ int GDBExecutor::LaunchProcess(wxString const &cmd, wxString const& cwd, int id_
         return -1;
 
     // start the gdb process
-    m_pPipedProcess = new PipedProcess(&m_pPipedProcess, event_handler, id_gdb_process, true, cwd);
+    m_pPipedProcess = new GDBProcess(&m_pPipedProcess, event_handler, id_gdb_process, cwd);
     logger.Log(_("Starting debugger: "));
     logger.Debug(_T("Executing command: ") + cmd);
     m_pid = wxExecute(cmd, wxEXEC_ASYNC | wxEXEC_MAKE_GROUP_LEADER, m_pPipedProcess);
@@ -355,6 +691,9 @@ long GDBExecutor::GetChildPID()
 
 bool GDBExecutor::ProcessHasInput()
 {
+    // the reader thread owns the pipes, PipedProcess must not read them too
+    if(m_output_reader)
+        return false;
     return m_pPipedProcess && m_pPipedProcess->HasInput();
 }
 
@@ -485,6 +824,102 @@ wxString GDBExecutor::GetOutput()
     return wxEmptyString;
 }
 
+int GDBExecutor::ReceiveOutput(wxString const &output, bool line_end)
+{
+    wxScopedCharBuffer utf8 = output.utf8_str();
+    m_framer.Append(utf8.data(), utf8.length());
+    if(line_end)
+        m_framer.Append("\n", 1);
+    return ReceiveOutput(NULL, 0);
+}
+
+int GDBExecutor::ReceiveOutput(char const *data, size_t length)
+{
+    m_framer.Append(data, length);
+
+    int count = 0;
+    Span line;
+    while(m_framer.Next(line))
+    {
+        ProcessOutput(line.data, line.length);
+        ++count;
+    }
+    return count;
+}
+
+bool GDBExecutor::StartOutputReader(wxEvtHandler *event_handler, int id)
+{
+#ifndef __WXMSW__
+    if(not m_pPipedProcess || m_output_reader)
+        return m_output_reader != NULL;
+
+    // the unix pipe streams of wxProcess are file streams
+    wxFileInputStream *out = dynamic_cast<wxFileInputStream*>(m_pPipedProcess->GetInputStream());
+    wxFileInputStream *err = dynamic_cast<wxFileInputStream*>(m_pPipedProcess->GetErrorStream());
+    if(not out || !out->GetFile() || out->GetFile()->fd() < 0)
+        return false;
+    // PipedProcess closes its fds when GDB exits, before StopOutputReader is called
+    int fd_out = dup(out->GetFile()->fd());
+    if(fd_out < 0)
+        return false;
+    int fd_err = err && err->GetFile() && err->GetFile()->fd() >= 0 ? dup(err->GetFile()->fd()) : -1;
+
+    m_output_reader = new OutputReader(fd_out, fd_err, event_handler, id);
+    if(m_output_reader->Run() != wxTHREAD_NO_ERROR)
+    {
+        delete m_output_reader;
+        m_output_reader = NULL;
+        return false;
+    }
+    static_cast<GDBProcess*>(m_pPipedProcess)->SetReaderActive(true);
+    return true;
+#else
+    // the pipes are overlapped handles on windows, the timer polls them
+    wxUnusedVar(event_handler);
+    wxUnusedVar(id);
+    return false;
+#endif
+}
+
+int GDBExecutor::ProcessReceivedOutput()
+{
+    if(not m_output_reader)
+        return 0;
+    // cleared first, a line pushed during the loop wakes us again
+    m_output_reader->ClearWakePending();
+
+    int count = 0;
+    while(OutputLine *line = m_output_reader->Pop())
+    {
+        ProcessOutput(*line);
+        delete line;
+        ++count;
+    }
+
+    for(int pipe = 0; pipe < 2; ++pipe)
+    {
+        int error = m_output_reader->TakeClosed(pipe);
+        if(error == OutputReader::c_open || not m_logger)
+            continue;
+        wxString reason = error == 0 ? wxString(_T("end of file")) : wxString(wxSysErrorMsg(error));
+        m_logger->Debug(wxString::Format(_T("GDB's %s is closed: %s"), pipe == 0 ? _T("stdout") : _T("stderr"),
+                                         reason.wx_str()),
+                        Logger::Line::Error);
+    }
+    return count;
+}
+
+void GDBExecutor::StopOutputReader()
+{
+    if(not m_output_reader)
+        return;
+    if(m_pPipedProcess)
+        static_cast<GDBProcess*>(m_pPipedProcess)->SetReaderActive(false);
+    m_output_reader->Delete();
+    delete m_output_reader; // the lines not processed yet are dropped
+    m_output_reader = NULL;
+}
+
 bool GDBExecutor::DoExecute(dbg_mi::CommandID const &id, wxString const &cmd)
 {
     if(not m_pPipedProcess)
@@ -499,9 +934,25 @@ bool GDBExecutor::DoExecute(dbg_mi::CommandID const &id, wxString const &cmd)
     m_pPipedProcess->SendString(id.ToString() + cmd);
     return true;
 }
+bool GDBExecutor::DoExecuteBatch(wxString const &commands, int count)
+{
+    if(not m_pPipedProcess)
+        return false;
+    if(not m_stopped && m_logger)
+    {
+        m_logger->Debug(wxString::Format(_T("GDBExecutor is not stopped, but %d commands were executed!"),
+                                         count)
+                        );
+    }
+    // SendString adds the line end of the last command
+    m_pPipedProcess->SendString(commands);
+    return true;
+}
 void GDBExecutor::DoClear()
 {
     m_stopped = true;
+    StopOutputReader();
+    m_framer.Clear();
     if (m_pPipedProcess)
         delete m_pPipedProcess;
     m_pPipedProcess = NULL;
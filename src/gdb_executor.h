@@ -1,7 +1,14 @@
 #ifndef _DEBUGGER_GDB_MI_GDB_EXECUTOR_H_
 #define _DEBUGGER_GDB_MI_GDB_EXECUTOR_H_
 
+#include <deque>
+#include <utility>
+#include <vector>
+#include <wx/timer.h>
+
 #include "cmd_queue.h"
+#include "command_history.h"
+#include "line_framer.h"
 
 class cbDebuggerPlugin;
 class PipedProcess;
@@ -14,33 +21,90 @@ class ProjectBuildTarget;
 namespace dbg_mi
 // ----------------------------------------------------------------------------
 {
+// The debug lines are buffered and written to the log pane in batches by a timer,
+// one log entry per run of lines of the same level.
 class LogPaneLogger : public Logger
 {
+    struct Record
+    {
+        wxString line;
+        Line::Type type;
+    };
+    class FlushTimer : public wxTimer
+    {
+    public:
+        FlushTimer(LogPaneLogger &logger) : m_logger(logger) {}
+        virtual void Notify() { m_logger.Flush(); }
+    private:
+        LogPaneLogger &m_logger;
+    };
 public:
-    LogPaneLogger(cbDebuggerPlugin *plugin) : m_plugin(plugin), m_shutdowned(false) {}
+    enum DebugLevel
+    {
+        DebugNone = 0,
+        DebugErrors,        // errors and program state
+        DebugCommands,      // + the commands sent
+        DebugOutput,        // + GDB's output
+        DebugAll            // + the plugin's own debug lines
+    };
+public:
+    LogPaneLogger(cbDebuggerPlugin *plugin);
+    ~LogPaneLogger();
 
     virtual void Log(wxString const &line, Log::Type type = Log::Normal);
     virtual void Debug(wxString const &line, Line::Type type = Line::Debug);
+    virtual bool IsDebugEnabled(Line::Type type = Line::Debug) const;
+    using Logger::IsDebugEnabled;
+    virtual Verbosity::Type GetVerbosity(Category::Type category) const { return m_verbosity[category]; }
     virtual Line const* GetDebugLine(int WXUNUSED(index)) const { return NULL; }
 
-    virtual void AddCommand(wxString const &command) { m_commands.push_back(command); }
-    virtual int GetCommandCount() const { return m_commands.size(); }
-    virtual wxString const& GetCommand(int index) const
-    {
-        Commands::const_iterator it = m_commands.begin();
-        std::advance(it, index);
-        return *it;
-    }
-    virtual void ClearCommand() { m_commands.clear(); }
-
-    void MarkAsShutdowned() { m_shutdowned = true; }
+    void SetDebugLevel(int level) { m_debug_level = level; }
+    // Longer lines are cut in the log pane, GetFullRecord has them whole; 0 is no limit
+    void SetMaxLineLength(int length) { m_max_line_length = length; }
+    // "<category>=<verbosity>,...", e.g. "watches=trace,threads=quiet"; "all" is every category.
+    // The categories not named are normal.
+    void SetVerbosity(wxString const &spec);
+    // Writes the buffered debug lines to the log pane
+    void Flush();
+
+    // The last few truncated lines are kept, 'number' is the one shown in the log pane.
+    bool GetFullRecord(int number, wxString &text) const;
+    int GetLastTruncatedRecord() const { return m_truncated_records; }
+
+    virtual void AddCommand(wxString const &command) { m_commands.Add(command); }
+    virtual int GetCommandCount() const { return m_commands.GetCount(); }
+    virtual wxString GetCommand(int index) const { return m_commands.Get(index); }
+    virtual void ClearCommand() { m_commands.Clear(); }
+    // The commands kept in memory, the older ones go to a journal file
+    void SetCommandHistorySize(int size);
+
+    void MarkAsShutdowned();
+private:
+    static int GetDebugLevel(Line::Type type);
+    void DiscardRecords();
 private:
-    typedef std::vector<wxString> Commands;
-    Commands m_commands;
+    CommandHistory m_commands;
     cbDebuggerPlugin *m_plugin;
     bool m_shutdowned;
+
+    static int const c_flush_interval = 100; // ms
+    static size_t const c_max_records = 4096; // flushed early when this many wait
+    typedef std::vector<Record> Records;
+    Records m_records;
+    Records m_flushed_records; // swapped with m_records, both keep their capacity
+    FlushTimer m_flush_timer;
+    int m_debug_level;
+    int m_max_line_length;
+    Verbosity::Type m_verbosity[Category::Count];
+
+    static size_t const c_kept_full_records = 32;
+    typedef std::deque<std::pair<int, wxString> > FullRecords;
+    FullRecords m_full_records;
+    int m_truncated_records;
 };
 
+class OutputReader;
+
 class GDBExecutor : public CommandExecutor
 {
     GDBExecutor(GDBExecutor &o);
@@ -63,6 +127,21 @@ public:
 
     virtual wxString GetOutput();
 
+    // Adds output of the GDB process, the complete lines are passed to ProcessOutput as a batch.
+    // PipedProcess reads whole lines and drops the line end, 'line_end' puts it back.
+    // Returns the number of lines processed.
+    int ReceiveOutput(wxString const &output, bool line_end = true);
+    int ReceiveOutput(char const *data, size_t length);
+
+    // Starts a thread which reads the stdout/stderr pipes of GDB and parses the records.
+    // It sends a wxThreadEvent with 'id' to 'event_handler' when lines are waiting, they are
+    // logged and queued by ProcessReceivedOutput. Returns false if the pipes can't be read
+    // on this platform, then PipedProcess reads them and the output is polled.
+    bool StartOutputReader(wxEvtHandler *event_handler, int id);
+    // Returns the number of lines processed.
+    int ProcessReceivedOutput();
+    bool HasOutputReader() const { return m_output_reader != NULL; }
+
     void SetAttachedPID(long pid) { m_attached_pid = pid; }
     long GetAttachedPID() const { return m_attached_pid; }
 
@@ -71,14 +150,18 @@ public:
 
 protected:
     virtual bool DoExecute(dbg_mi::CommandID const &id, wxString const &cmd);
+    virtual bool DoExecuteBatch(wxString const &commands, int count);
     virtual void DoClear();
 private:
     long GetChildPID();
     void InterruptChild(int child_pid);
+    void StopOutputReader();
 
 private:
     PipedProcess *m_pPipedProcess;
     long m_pid, m_child_pid, m_attached_pid;
+    LineFramer m_framer;
+    OutputReader *m_output_reader;
 
     bool m_stopped;
     bool m_interupting;
@@ -0,0 +1,132 @@
+#include "line_framer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dbg_mi
+{
+
+static bool IsLineSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+LineFramer::LineFramer(size_t capacity) :
+    m_mask(0),
+    m_head(0),
+    m_tail(0),
+    m_scan(0)
+{
+    size_t size = 1024;
+    while(size < capacity)
+        size <<= 1;
+    m_buffer.resize(size);
+    m_mask = size - 1;
+}
+
+void LineFramer::Clear()
+{
+    m_head = m_tail = m_scan = 0;
+    m_line.clear();
+}
+
+void LineFramer::Reserve(size_t length)
+{
+    size_t used = m_tail - m_head;
+    if(used + length <= m_buffer.size())
+        return;
+
+    size_t size = m_buffer.size();
+    while(size < used + length)
+        size <<= 1;
+
+    // the pending bytes are moved to the start of the new ring
+    std::vector<char> buffer(size);
+    size_t start = m_head & m_mask;
+    size_t first = std::min(used, m_buffer.size() - start);
+    std::memcpy(&buffer[0], &m_buffer[start], first);
+    if(first < used)
+        std::memcpy(&buffer[first], &m_buffer[0], used - first);
+
+    m_buffer.swap(buffer);
+    m_mask = size - 1;
+    m_scan -= m_head;
+    m_tail -= m_head;
+    m_head = 0;
+}
+
+void LineFramer::Append(char const *data, size_t length)
+{
+    if(length == 0)
+        return;
+    Reserve(length);
+
+    size_t start = m_tail & m_mask;
+    size_t first = std::min(length, m_buffer.size() - start);
+    std::memcpy(&m_buffer[start], data, first);
+    if(first < length)
+        std::memcpy(&m_buffer[0], data + first, length - first);
+    m_tail += length;
+}
+
+// Searches the next '\n' in [from, m_tail), the ring is searched in at most two pieces.
+char const * LineFramer::FindLineEnd(size_t from, size_t &pos) const
+{
+    while(from < m_tail)
+    {
+        size_t start = from & m_mask;
+        size_t length = std::min(m_tail - from, m_buffer.size() - start);
+        char const *found = static_cast<char const*>(std::memchr(&m_buffer[start], '\n', length));
+        if(found)
+        {
+            pos = from + (found - &m_buffer[start]);
+            return found;
+        }
+        from += length;
+    }
+    return NULL;
+}
+
+bool LineFramer::Next(Span &line)
+{
+    while(true)
+    {
+        size_t end;
+        if(not FindLineEnd(m_scan, end))
+        {
+            m_scan = m_tail;
+            if(m_head == m_tail)
+                m_head = m_tail = m_scan = 0;
+            return false;
+        }
+
+        size_t start = m_head & m_mask;
+        size_t length = end - m_head;
+        char const *data;
+        if(start + length <= m_buffer.size())
+            data = &m_buffer[start];
+        else
+        {
+            size_t first = m_buffer.size() - start;
+            m_line.assign(&m_buffer[start], first);
+            m_line.append(&m_buffer[0], length - first);
+            data = m_line.data();
+        }
+        m_head = m_scan = end + 1;
+
+        while(length > 0 && IsLineSpace(data[0]))
+        {
+            ++data;
+            --length;
+        }
+        while(length > 0 && IsLineSpace(data[length - 1]))
+            --length;
+        if(length == 0)
+            continue;
+
+        line = Span(data, length);
+        return true;
+    }
+}
+
+} // namespace dbg_mi
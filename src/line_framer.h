@@ -0,0 +1,47 @@
+#ifndef _DEBUGGER_MI_LINE_FRAMER_H_
+#define _DEBUGGER_MI_LINE_FRAMER_H_
+
+#include <string>
+#include <vector>
+
+#include "cmd_result_tokens.h"
+
+namespace dbg_mi
+{
+
+// Cuts the output bytes of GDB into lines. A line can be split across reads, the
+// incomplete tail is kept until its line end arrives. The bytes are kept in a ring
+// that grows only when a pending line doesn't fit, so a steady stream of output
+// doesn't allocate.
+class LineFramer
+{
+public:
+    explicit LineFramer(size_t capacity = 64 * 1024);
+
+    void Append(char const *data, size_t length);
+
+    // Gets the next complete line, without the line end and the surrounding white space.
+    // Empty lines are skipped. The span is valid until the next call to Next or Append.
+    bool Next(Span &line);
+
+    // Bytes of the incomplete line at the end
+    size_t GetPendingLength() const { return m_tail - m_head; }
+    size_t GetCapacity() const { return m_buffer.size(); }
+
+    void Clear();
+private:
+    void Reserve(size_t length);
+    char const * FindLineEnd(size_t from, size_t &pos) const;
+private:
+    std::vector<char> m_buffer; // the size is a power of 2
+    size_t m_mask;
+    // absolute stream positions, the index in m_buffer is 'pos & m_mask'
+    size_t m_head;  // start of the first line not handed out
+    size_t m_tail;  // end of the data
+    size_t m_scan;  // m_head..m_scan has no line end
+    std::string m_line; // a line that wraps around the end of the ring is copied here
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_LINE_FRAMER_H_
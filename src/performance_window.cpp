@@ -0,0 +1,108 @@
+#include "performance_window.h"
+
+#include <sdk.h>
+#include <wx/button.h>
+#include <wx/file.h>
+#include <wx/filedlg.h>
+#include <wx/filename.h>
+#include <wx/sizer.h>
+#include <wx/textctrl.h>
+
+#include "command_stats.h"
+
+namespace dbg_mi
+{
+
+// ----------------------------------------------------------------------------
+PerformanceWindow::PerformanceWindow(wxWindow *parent, CommandStats &stats) :
+// ----------------------------------------------------------------------------
+    wxScrollingDialog(parent, -1, _("MI performance"), wxDefaultPosition, wxSize(760, 420),
+                      wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER | wxMAXIMIZE_BOX | wxMINIMIZE_BOX),
+    m_stats(stats),
+    m_font(8, wxFONTFAMILY_MODERN, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL)
+{
+    wxSizer* sizer = new wxBoxSizer(wxVERTICAL);
+    m_text = new wxTextCtrl(this, -1, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+                            wxTE_READONLY | wxTE_MULTILINE | wxTE_RICH2 | wxHSCROLL);
+    m_text->SetFont(m_font);
+    sizer->Add(m_text, 1, wxGROW);
+
+    wxSizer* buttons = new wxBoxSizer(wxHORIZONTAL);
+    wxButton *refresh = new wxButton(this, wxID_ANY, _("Refresh"));
+    wxButton *reset = new wxButton(this, wxID_ANY, _("Reset"));
+    wxButton *json = new wxButton(this, wxID_ANY, _("Export JSON..."));
+    wxButton *csv = new wxButton(this, wxID_ANY, _("Export CSV..."));
+    buttons->Add(refresh, 0, wxALL, 4);
+    buttons->Add(reset, 0, wxALL, 4);
+    buttons->AddStretchSpacer();
+    buttons->Add(json, 0, wxALL, 4);
+    buttons->Add(csv, 0, wxALL, 4);
+    sizer->Add(buttons, 0, wxGROW);
+
+    refresh->Bind(wxEVT_BUTTON, &PerformanceWindow::OnRefresh, this);
+    reset->Bind(wxEVT_BUTTON, &PerformanceWindow::OnReset, this);
+    json->Bind(wxEVT_BUTTON, &PerformanceWindow::OnExportJSON, this);
+    csv->Bind(wxEVT_BUTTON, &PerformanceWindow::OnExportCSV, this);
+
+    SetSizer(sizer);
+    sizer->Layout();
+    UpdateStats();
+}
+// ----------------------------------------------------------------------------
+void PerformanceWindow::UpdateStats()
+// ----------------------------------------------------------------------------
+{
+    wxString text = m_stats.FormatText();
+    text += _T("\ngdb: sent -> result received, parse: building the result tree,\n")
+            _T("queue: received -> action callback (without parse), callback: the action's work,\n")
+            _T("total: sent -> callback done, finish: total of the commands which finished their action,\n")
+            _T("gdb-wall, gdb-cpu: the time GDB reports with -enable-timings (see the enable_timings option)\n");
+    m_text->SetValue(text);
+    m_text->SetFont(m_font);
+}
+// ----------------------------------------------------------------------------
+void PerformanceWindow::OnRefresh(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    UpdateStats();
+}
+// ----------------------------------------------------------------------------
+void PerformanceWindow::OnReset(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    m_stats.Clear();
+    UpdateStats();
+}
+// ----------------------------------------------------------------------------
+wxString PerformanceWindow::SelectExportFile(wxString const &title, wxString const &wildcard)
+// ----------------------------------------------------------------------------
+{
+    wxFileDialog dlg(this, title, wxEmptyString, wxEmptyString, wildcard,
+                     wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    PlaceWindow(&dlg);
+    if (dlg.ShowModal() != wxID_OK)
+        return wxEmptyString;
+    return dlg.GetPath();
+}
+// ----------------------------------------------------------------------------
+void PerformanceWindow::OnExportJSON(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    wxString path = SelectExportFile(_("Export MI performance as JSON"), _T("JSON files (*.json)|*.json"));
+    if (path.empty())
+        return;
+    m_stats.SaveJSON(wxFileName(path));
+}
+// ----------------------------------------------------------------------------
+void PerformanceWindow::OnExportCSV(wxCommandEvent& /*event*/)
+// ----------------------------------------------------------------------------
+{
+    wxString path = SelectExportFile(_("Export MI performance as CSV"), _T("CSV files (*.csv)|*.csv"));
+    if (path.empty())
+        return;
+    wxFile file(path, wxFile::write);
+    if (not file.IsOpened() || !file.Write(m_stats.FormatCSV(), wxConvUTF8))
+        cbMessageBox(_("Can't write ") + path, _("MI performance"), wxOK | wxICON_ERROR, this);
+}
+
+} // namespace dbg_mi
@@ -0,0 +1,37 @@
+#ifndef _DEBUGGER_MI_PERFORMANCE_WINDOW_H_
+#define _DEBUGGER_MI_PERFORMANCE_WINDOW_H_
+
+#include <wx/font.h>
+#include <scrollingdialog.h>
+
+class wxCommandEvent;
+class wxTextCtrl;
+
+namespace dbg_mi
+{
+
+class CommandStats;
+
+// ----------------------------------------------------------------------------
+class PerformanceWindow : public wxScrollingDialog
+// ----------------------------------------------------------------------------
+{
+    public:
+        PerformanceWindow(wxWindow *parent, CommandStats &stats);
+
+        void UpdateStats();
+    private:
+        void OnRefresh(wxCommandEvent &event);
+        void OnReset(wxCommandEvent &event);
+        void OnExportJSON(wxCommandEvent &event);
+        void OnExportCSV(wxCommandEvent &event);
+        wxString SelectExportFile(wxString const &title, wxString const &wildcard);
+    private:
+        CommandStats &m_stats;
+        wxTextCtrl* m_text;
+        wxFont m_font;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_PERFORMANCE_WINDOW_H_
@@ -0,0 +1,92 @@
+#include "session_recorder.h"
+
+#include <cstdio>
+
+#include "cmd_queue.h"
+#include "command_stats.h"
+
+namespace dbg_mi
+{
+
+char const SessionRecorder::c_header[] = "# gdbmi session 1";
+
+SessionRecorder::SessionRecorder() :
+    m_last_time(0),
+    m_records(0)
+{
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    Close();
+}
+
+bool SessionRecorder::Open(wxString const &filename)
+{
+    Close();
+    if(not m_file.Open(filename, wxFile::write))
+        return false;
+    m_filename = filename;
+    m_records = 0;
+    m_last_time = CommandStats::Now();
+    m_buffer = c_header;
+    m_buffer += '\n';
+    return true;
+}
+
+void SessionRecorder::Close()
+{
+    if(not m_file.IsOpened())
+        return;
+    Flush();
+    m_file.Close();
+}
+
+void SessionRecorder::RecordCommand(int64_t time, CommandID const &id, wxString const &command)
+{
+    Append(time, '>', wxString::Format(_T("%d %d "), id.GetActionID(), id.GetCommandID()) + command);
+}
+
+void SessionRecorder::RecordOutput(int64_t time, wxString const &line)
+{
+    Append(time, '<', line);
+}
+
+void SessionRecorder::Append(int64_t time, char kind, wxString const &text)
+{
+    if(not m_file.IsOpened())
+        return;
+
+    // the output is stamped on the reader thread, it may be a bit older than the last command
+    int64_t delta = time > m_last_time ? time - m_last_time : 0;
+    m_last_time += delta;
+
+    char prefix[32];
+    std::snprintf(prefix, sizeof(prefix), "%lld %c ", static_cast<long long>(delta), kind);
+    m_buffer += prefix;
+    wxScopedCharBuffer utf8 = text.utf8_str();
+    std::string::size_type start = m_buffer.length();
+    m_buffer.append(utf8.data(), utf8.length());
+    // a record is one line
+    for(std::string::size_type ii = start; ii < m_buffer.length(); ++ii)
+    {
+        if(m_buffer[ii] == '\n' || m_buffer[ii] == '\r')
+            m_buffer[ii] = ' ';
+    }
+    m_buffer += '\n';
+    ++m_records;
+
+    if(m_buffer.length() >= c_flush_size)
+        Flush();
+}
+
+void SessionRecorder::Flush()
+{
+    if(m_buffer.empty())
+        return;
+    if(m_file.Write(m_buffer.data(), m_buffer.length()) != m_buffer.length())
+        m_file.Close(); // the disk is full, the recording stops
+    m_buffer.clear();
+}
+
+} // namespace dbg_mi
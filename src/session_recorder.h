@@ -0,0 +1,52 @@
+#ifndef _DEBUGGER_MI_SESSION_RECORDER_H_
+#define _DEBUGGER_MI_SESSION_RECORDER_H_
+
+#include <cstdint>
+#include <string>
+#include <wx/file.h>
+#include <wx/string.h>
+
+namespace dbg_mi
+{
+
+class CommandID;
+
+// Appends the commands sent to GDB and the lines it printed to a file, one per line:
+//   <microseconds since the previous line> > <action id> <command id> <command>
+//   <microseconds since the previous line> < <output line>
+// The first line is the c_header. SessionReplay plays the file back.
+class SessionRecorder
+{
+    SessionRecorder(SessionRecorder const &);
+    SessionRecorder& operator =(SessionRecorder const &);
+public:
+    static char const c_header[];
+
+    SessionRecorder();
+    ~SessionRecorder();
+
+    bool Open(wxString const &filename);
+    void Close();
+    bool IsRecording() const { return m_file.IsOpened(); }
+    wxString const& GetFilename() const { return m_filename; }
+    int GetRecordCount() const { return m_records; }
+
+    // 'time' is a CommandStats::Now() stamp
+    void RecordCommand(int64_t time, CommandID const &id, wxString const &command);
+    void RecordOutput(int64_t time, wxString const &line);
+private:
+    void Append(int64_t time, char kind, wxString const &text);
+    void Flush();
+private:
+    static size_t const c_flush_size = 64 * 1024;
+
+    wxFile m_file;
+    wxString m_filename;
+    std::string m_buffer;
+    int64_t m_last_time;
+    int m_records;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_SESSION_RECORDER_H_
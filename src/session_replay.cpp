@@ -0,0 +1,224 @@
+#include "session_replay.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <sdk.h>
+#include <debuggermanager.h>
+#include <manager.h>
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#include "session_recorder.h"
+
+namespace dbg_mi
+{
+
+// Converts every value of the result, like an action reading all of it would.
+static void DecodeValue(ResultValue const &value)
+{
+    if(value.GetType() == ResultValue::Simple)
+    {
+        value.GetSimpleValue();
+        return;
+    }
+    int size = value.GetTupleSize();
+    for(int ii = 0; ii < size; ++ii)
+    {
+        ResultValue const *child = value.GetTupleValueByIndex(ii);
+        if(child)
+            DecodeValue(*child);
+    }
+}
+
+void ReplayAction::OnCommandOutput(CommandID const &/*id*/, ResultParser const &result)
+{
+    DecodeValue(result.GetResultValue());
+    if(++m_results >= m_expected_results)
+        Finish();
+}
+
+SessionReplay::SessionReplay() :
+    m_real_time(false),
+    m_start(0),
+    m_position(0),
+    m_commands(0),
+    m_outputs(0)
+{
+}
+
+bool SessionReplay::Load(wxString const &filename, wxString &error)
+{
+    m_entries.clear();
+    m_expected_results.clear();
+
+    wxFile file;
+    if(not file.Open(filename, wxFile::read))
+    {
+        error = _("Can't open ") + filename;
+        return false;
+    }
+    wxFileOffset length = file.Length();
+    std::string buffer(length > 0 ? length : 0, '\0');
+    if(length > 0 && file.Read(&buffer[0], buffer.length()) != static_cast<ssize_t>(buffer.length()))
+    {
+        error = _("Can't read ") + filename;
+        return false;
+    }
+
+    size_t header_length = std::strlen(SessionRecorder::c_header);
+    if(buffer.compare(0, header_length, SessionRecorder::c_header) != 0)
+    {
+        error = filename + _(" isn't a recorded MI session");
+        return false;
+    }
+
+    int64_t time = 0;
+    std::string::size_type begin = buffer.find('\n');
+    while(begin != std::string::npos && ++begin < buffer.length())
+    {
+        std::string::size_type eol = buffer.find('\n', begin);
+        std::string line = buffer.substr(begin, eol == std::string::npos ? std::string::npos : eol - begin);
+        begin = eol;
+
+        // <delta> <kind> <text>
+        char const *start = line.c_str();
+        char *end;
+        long long delta = std::strtoll(start, &end, 10);
+        if(end == start || end[0] != ' ' || (end[1] != '>' && end[1] != '<') || end[2] != ' ')
+            continue;
+
+        Entry entry;
+        time += delta;
+        entry.time = time;
+        entry.command = end[1] == '>';
+        entry.action = entry.command_id = 0;
+        char const *text = end + 3;
+        if(entry.command)
+        {
+            // <action id> <command id> <command>
+            entry.action = std::strtol(text, &end, 10);
+            entry.command_id = std::strtol(end, &end, 10);
+            text = *end == ' ' ? end + 1 : end;
+            ++m_expected_results[entry.action];
+        }
+        entry.text = text;
+        m_entries.push_back(entry);
+    }
+    return true;
+}
+
+void SessionReplay::Start(bool real_time)
+{
+    m_executor.Clear();
+    m_actions.Clear();
+    m_action_ids.clear();
+    m_execute_ids.clear();
+    m_notifications = CountNotifications();
+    m_real_time = real_time;
+    m_start = CommandStats::Now();
+    m_position = 0;
+    m_commands = m_outputs = 0;
+}
+
+int64_t SessionReplay::GetElapsed() const
+{
+    return CommandStats::Now() - m_start;
+}
+
+bool SessionReplay::Step()
+{
+    if(m_position >= static_cast<int>(m_entries.size()))
+        return false;
+
+    Entry const &entry = m_entries[m_position];
+    if(m_real_time)
+    {
+        // the caller gets the control back during the long pauses of the session
+        int64_t wait = m_start + entry.time - CommandStats::Now();
+        if(wait > 0)
+        {
+            int64_t const c_max_wait = 100000;
+            wxMicroSleep(std::min(wait, c_max_wait));
+            if(wait > c_max_wait)
+                return true;
+        }
+    }
+
+    if(entry.command)
+        PlayCommand(entry);
+    else
+        PlayOutput(entry);
+    ++m_position;
+    return true;
+}
+
+void SessionReplay::PlayCommand(Entry const &entry)
+{
+    ++m_commands;
+    wxString command = wxString::FromUTF8(entry.text.data(), entry.text.length());
+
+    // the commands executed directly, outside of an action
+    if(entry.action == 0)
+    {
+        CommandID id = m_executor.Execute(command);
+        m_execute_ids[entry.command_id] = id.GetCommandID();
+        return;
+    }
+
+    ActionIDs::iterator it = m_action_ids.find(entry.action);
+    if(it == m_action_ids.end())
+    {
+        ReplayAction *action = new ReplayAction(m_expected_results[entry.action]);
+        m_actions.Add(action);
+        ReplayedAction replayed;
+        replayed.id = action->GetID();
+        // the recording may have started in the middle of the action
+        replayed.first_command = entry.command_id;
+        it = m_action_ids.insert(std::make_pair(entry.action, replayed)).first;
+    }
+    Action *action = m_actions.Find(it->second.id);
+    if(action)
+    {
+        action->Execute(command);
+        m_actions.Run(m_executor);
+    }
+}
+
+void SessionReplay::PlayOutput(Entry const &entry)
+{
+    ++m_outputs;
+
+    // the tokens of the recording are mapped to the ids of the replay
+    std::string line(entry.text);
+    RecordHeader header;
+    if(DecodeRecordHeader(line.data(), line.length(), header) && header.has_token)
+    {
+        CommandID id;
+        if(header.action == 0)
+        {
+            std::map<int, int>::const_iterator it = m_execute_ids.find(header.command);
+            if(it != m_execute_ids.end())
+                id = CommandID(0, it->second);
+        }
+        else
+        {
+            ActionIDs::const_iterator it = m_action_ids.find(header.action);
+            if(it != m_action_ids.end())
+                id = CommandID(it->second.id, header.command - it->second.first_command);
+        }
+        if(id.GetActionID() >= 0)
+        {
+            wxScopedCharBuffer token = id.ToString().utf8_str();
+            line = std::string(token.data(), token.length()) + line.substr(header.prefix_pos);
+        }
+    }
+
+    m_executor.ProcessOutput(line.data(), line.length());
+    DispatchResults(m_executor, m_actions, m_notifications);
+    m_actions.Run(m_executor);
+}
+
+} // namespace dbg_mi
@@ -0,0 +1,111 @@
+#ifndef _DEBUGGER_MI_SESSION_REPLAY_H_
+#define _DEBUGGER_MI_SESSION_REPLAY_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cmd_queue.h"
+
+namespace dbg_mi
+{
+
+// A CommandExecutor without GDB, the commands go nowhere.
+// ----------------------------------------------------------------------------
+class ReplayExecutor : public CommandExecutor
+// ----------------------------------------------------------------------------
+{
+public:
+    virtual wxString GetOutput() { return wxEmptyString; }
+protected:
+    virtual bool DoExecute(dbg_mi::CommandID const &/*id*/, wxString const &/*cmd*/) { return true; }
+    virtual bool DoExecuteBatch(wxString const &/*commands*/, int /*count*/) { return true; }
+    virtual void DoClear() {}
+};
+
+// Stands for an action of the recorded session: it sends the commands the action
+// sent and decodes all of their results.
+// ----------------------------------------------------------------------------
+class ReplayAction : public Action
+// ----------------------------------------------------------------------------
+{
+public:
+    explicit ReplayAction(int expected_results) :
+        m_expected_results(expected_results),
+        m_results(0)
+    {
+    }
+
+    virtual void OnCommandOutput(CommandID const &id, ResultParser const &result);
+protected:
+    virtual void OnStart() {}
+private:
+    int m_expected_results;
+    int m_results;
+};
+
+// Plays a file of SessionRecorder back through a ReplayExecutor and an ActionsMap,
+// at full speed or with the recorded delays. The executor's CommandStats then have
+// the plugin side of the timings.
+// ----------------------------------------------------------------------------
+class SessionReplay
+// ----------------------------------------------------------------------------
+{
+    struct Entry
+    {
+        int64_t time;       // microseconds since the start of the recording
+        bool command;
+        int action;         // the recorded ids of a command
+        int command_id;
+        std::string text;   // UTF-8
+    };
+public:
+    SessionReplay();
+
+    bool Load(wxString const &filename, wxString &error);
+    void Start(bool real_time);
+    // Plays the next line, in real time it waits for it 100 ms at most.
+    // Returns false at the end.
+    bool Step();
+
+    int GetPosition() const { return m_position; }
+    int GetCount() const { return m_entries.size(); }
+    int GetCommandCount() const { return m_commands; }
+    int GetOutputCount() const { return m_outputs; }
+    int GetNotificationCount() const { return m_notifications.count; }
+    int64_t GetRecordedDuration() const { return m_entries.empty() ? 0 : m_entries.back().time; }
+    int64_t GetElapsed() const;
+    CommandStats& GetStats() { return m_executor.GetStats(); }
+private:
+    void PlayCommand(Entry const &entry);
+    void PlayOutput(Entry const &entry);
+private:
+    struct CountNotifications
+    {
+        CountNotifications() : count(0) {}
+        void operator()(ResultParser const &/*parser*/, int times) { count += times; }
+        int count;
+    };
+    struct ReplayedAction
+    {
+        int id;
+        int first_command; // the recorded id of its first command
+    };
+    typedef std::map<int, ReplayedAction> ActionIDs; // by recorded action id
+
+    std::vector<Entry> m_entries;
+    std::map<int, int> m_expected_results; // by recorded action id
+    ReplayExecutor m_executor;
+    ActionsMap m_actions;
+    ActionIDs m_action_ids;
+    std::map<int, int> m_execute_ids; // the command ids of CommandExecutor::Execute, recorded -> replayed
+    CountNotifications m_notifications;
+    bool m_real_time;
+    int64_t m_start;
+    int m_position;
+    int m_commands, m_outputs;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_SESSION_REPLAY_H_
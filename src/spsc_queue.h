@@ -0,0 +1,69 @@
+#ifndef _DEBUGGER_MI_SPSC_QUEUE_H_
+#define _DEBUGGER_MI_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace dbg_mi
+{
+
+// Bounded lock-free queue of pointers between one producer thread and one consumer thread.
+// Push is only called by the producer, Pop by the consumer. The queue doesn't own the items.
+template<typename T>
+class SpscQueue
+{
+    SpscQueue(SpscQueue const &);
+    SpscQueue& operator =(SpscQueue const &);
+public:
+    // 'capacity' is rounded up to a power of 2
+    explicit SpscQueue(size_t capacity = 4096) :
+        m_head(0),
+        m_tail(0)
+    {
+        size_t size = 2;
+        while(size < capacity)
+            size <<= 1;
+        m_items.resize(size, NULL);
+        m_mask = size - 1;
+    }
+
+    // Returns false if the queue is full.
+    bool Push(T *item)
+    {
+        assert(item);
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if(tail - m_head.load(std::memory_order_acquire) == m_items.size())
+            return false;
+        m_items[tail & m_mask] = item;
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns NULL if the queue is empty.
+    T* Pop()
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if(head == m_tail.load(std::memory_order_acquire))
+            return NULL;
+        T *item = m_items[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    bool Empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+private:
+    std::vector<T*> m_items;
+    size_t m_mask;
+    // the indexes are on separate cache lines, the two threads write one each
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+} // namespace dbg_mi
+
+#endif // _DEBUGGER_MI_SPSC_QUEUE_H_
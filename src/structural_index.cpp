@@ -0,0 +1,303 @@
+#include "structural_index.h"
+
+#include <cstring>
+
+#include "cmd_result_tokens.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define DBG_MI_X86_SIMD 1
+    #include <immintrin.h>
+#endif
+
+namespace dbg_mi
+{
+
+namespace
+{
+
+// One bit per byte of a 64 byte block
+struct BlockMasks
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op; // {}[]=,
+};
+
+typedef void (*ClassifyFunction)(char const *block, BlockMasks &masks);
+
+void ClassifyScalar(char const *block, BlockMasks &masks)
+{
+    masks.quote = masks.backslash = masks.op = 0;
+    for(int ii = 0; ii < 64; ++ii)
+    {
+        uint64_t bit = uint64_t(1) << ii;
+        switch(block[ii])
+        {
+        case '"':
+            masks.quote |= bit;
+            break;
+        case '\\':
+            masks.backslash |= bit;
+            break;
+        case '{':
+        case '}':
+        case '[':
+        case ']':
+        case '=':
+        case ',':
+            masks.op |= bit;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+#ifdef DBG_MI_X86_SIMD
+// '[' | 0x20 == '{' and ']' | 0x20 == '}', so the brackets need only two compares.
+
+__attribute__((target("sse2")))
+void ClassifySSE2(char const *block, BlockMasks &masks)
+{
+    __m128i const quote = _mm_set1_epi8('"');
+    __m128i const backslash = _mm_set1_epi8('\\');
+    __m128i const open = _mm_set1_epi8('{');
+    __m128i const close = _mm_set1_epi8('}');
+    __m128i const equal = _mm_set1_epi8('=');
+    __m128i const comma = _mm_set1_epi8(',');
+    __m128i const lower = _mm_set1_epi8(0x20);
+
+    masks.quote = masks.backslash = masks.op = 0;
+    for(int ii = 0; ii < 64; ii += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + ii));
+        __m128i folded = _mm_or_si128(v, lower);
+        __m128i op = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(v, equal), _mm_cmpeq_epi8(v, comma)));
+
+        masks.quote |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << ii;
+        masks.backslash |= uint64_t(uint16_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << ii;
+        masks.op |= uint64_t(uint16_t(_mm_movemask_epi8(op))) << ii;
+    }
+}
+
+__attribute__((target("avx2")))
+void ClassifyAVX2(char const *block, BlockMasks &masks)
+{
+    __m256i const quote = _mm256_set1_epi8('"');
+    __m256i const backslash = _mm256_set1_epi8('\\');
+    __m256i const open = _mm256_set1_epi8('{');
+    __m256i const close = _mm256_set1_epi8('}');
+    __m256i const equal = _mm256_set1_epi8('=');
+    __m256i const comma = _mm256_set1_epi8(',');
+    __m256i const lower = _mm256_set1_epi8(0x20);
+
+    masks.quote = masks.backslash = masks.op = 0;
+    for(int ii = 0; ii < 64; ii += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block + ii));
+        __m256i folded = _mm256_or_si256(v, lower);
+        __m256i op = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(v, equal), _mm256_cmpeq_epi8(v, comma)));
+
+        masks.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << ii;
+        masks.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << ii;
+        masks.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << ii;
+    }
+}
+#endif // DBG_MI_X86_SIMD
+
+struct Implementation
+{
+    ClassifyFunction classify;
+    char const *name;
+};
+
+Implementation ChooseImplementation()
+{
+#ifdef DBG_MI_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+    {
+        Implementation impl = { ClassifyAVX2, "avx2" };
+        return impl;
+    }
+    if(__builtin_cpu_supports("sse2"))
+    {
+        Implementation impl = { ClassifySSE2, "sse2" };
+        return impl;
+    }
+#endif
+    Implementation impl = { ClassifyScalar, "scalar" };
+    return impl;
+}
+
+Implementation const & GetImplementation()
+{
+    static Implementation const impl = ChooseImplementation();
+    return impl;
+}
+
+// Marks the characters preceded by an odd number of backslashes (see simdjson).
+// 'prev_escaped' carries the state over to the next block.
+inline uint64_t FindEscaped(uint64_t backslash, uint64_t &prev_escaped)
+{
+    uint64_t const even_bits = 0x5555555555555555ULL;
+
+    backslash &= ~prev_escaped;
+    uint64_t follows_escape = (backslash << 1) | prev_escaped;
+    uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+    uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+    prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts ? 1 : 0; // carry out
+    uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+    return (even_bits ^ invert_mask) & follows_escape;
+}
+
+// Bit n of the result is the xor of bits 0..n
+inline uint64_t PrefixXor(uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+inline int CountTrailingZeros(uint64_t bits)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#else
+    int count = 0;
+    while((bits & 1) == 0)
+    {
+        bits >>= 1;
+        ++count;
+    }
+    return count;
+#endif
+}
+
+} // anonymous namespace
+
+void StructuralIndex::Build(char const *buffer, int length)
+{
+    ClassifyFunction classify = GetImplementation().classify;
+
+    int const blocks = (length + 63) / 64;
+    m_bits.resize(blocks);
+    m_length = length;
+
+    uint64_t prev_escaped = 0;
+    uint64_t prev_in_string = 0;
+    char tail[64];
+
+    for(int block = 0; block < blocks; ++block)
+    {
+        char const *p = buffer + block * 64;
+        int const left = length - block * 64;
+        if(left < 64)
+        {
+            // pad with spaces, they are never structural
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, p, left);
+            p = tail;
+        }
+
+        BlockMasks masks;
+        classify(p, masks);
+
+        uint64_t escaped = FindEscaped(masks.backslash, prev_escaped);
+        uint64_t quote = masks.quote & ~escaped;
+        // the opening quote and the string contents are set, the closing quote isn't
+        uint64_t in_string = PrefixXor(quote) ^ prev_in_string;
+        prev_in_string = (in_string >> 63) ? ~uint64_t(0) : 0;
+
+        m_bits[block] = (masks.op & ~in_string) | quote;
+    }
+}
+
+int StructuralIndex::FindNext(int pos) const
+{
+    if(pos >= m_length)
+        return -1;
+
+    int block = pos / 64;
+    uint64_t bits = m_bits[block] & (~uint64_t(0) << (pos % 64));
+    while(bits == 0)
+    {
+        if(++block >= static_cast<int>(m_bits.size()))
+            return -1;
+        bits = m_bits[block];
+    }
+    return block * 64 + CountTrailingZeros(bits);
+}
+
+bool StructuralIndex::GetNextToken(char const *buffer, int length, int pos, Token &token) const
+{
+    while(pos < length && (buffer[pos] == ' ' || buffer[pos] == '\t'))
+        ++pos;
+
+    if(pos >= length)
+        return false;
+
+    switch(buffer[pos])
+    {
+    case '=':
+        token = Token(pos, pos + 1, Token::Equal);
+        return true;
+    case ',':
+        token = Token(pos, pos + 1, Token::Comma);
+        return true;
+    case '[':
+        token = Token(pos, pos + 1, Token::ListStart);
+        return true;
+    case ']':
+        token = Token(pos, pos + 1, Token::ListEnd);
+        return true;
+    case '{':
+        token = Token(pos, pos + 1, Token::TupleStart);
+        return true;
+    case '}':
+        token = Token(pos, pos + 1, Token::TupleEnd);
+        return true;
+
+    case '"':
+        {
+            // everything up to the closing quote is skipped by the index
+            int end = FindNext(pos + 1);
+            if(end == -1 || buffer[end] != '"')
+            {
+                token.end = -1;
+                return false;
+            }
+            token = Token(pos, end + 1, Token::String);
+            return true;
+        }
+
+    default:
+        // unquoted strings are short (class names, numbers), scan them
+        token.type = Token::String;
+        token.start = pos;
+        for(++pos; pos < length; ++pos)
+        {
+            char c = buffer[pos];
+            if(c == ' ' || c == '\t' || c == ',' || c == '=' || c == '{' || c == '}' || c == '[' || c == ']')
+                break;
+            // the index treats this as the start of a string, let the scalar tokenizer handle it
+            if(c == '"')
+                return false;
+        }
+        token.end = pos;
+        return true;
+    }
+}
+
+char const * StructuralIndex::GetImplementationName()
+{
+    return GetImplementation().name;
+}
+
+} // namespace dbg_mi
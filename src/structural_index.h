@@ -0,0 +1,42 @@
+#ifndef _Debugger_GDB_MI_STRUCTURAL_INDEX_H_
+#define _Debugger_GDB_MI_STRUCTURAL_INDEX_H_
+
+#include <stdint.h>
+#include <vector>
+
+namespace dbg_mi
+{
+
+struct Token;
+
+// Bitmap of the structural characters {}[]=," of a UTF-8 MI record, built in one
+// vectorized sweep (SSE2, or AVX2 if the cpu has it). Characters inside quoted
+// strings and escaped quotes are not marked, so the end of a string is the next bit.
+class StructuralIndex
+{
+public:
+    StructuralIndex() : m_length(0) {}
+
+    void Build(char const *buffer, int length);
+
+    // Returns the position of the first structural character >= pos, or -1.
+    int FindNext(int pos) const;
+
+    // Same contract as the scalar GetNextToken(buffer, length, pos, token),
+    // but skips over quoted strings using the index.
+    bool GetNextToken(char const *buffer, int length, int pos, Token &token) const;
+
+    // Name of the code path used by Build(), for the debug log.
+    static char const * GetImplementationName();
+private:
+    std::vector<uint64_t> m_bits;
+    int m_length;
+};
+
+// Records shorter than this are tokenized with the scalar code,
+// the pre-pass doesn't pay for itself on them.
+const int c_structural_index_min_length = 1024;
+
+} // namespace dbg_mi
+
+#endif // _Debugger_GDB_MI_STRUCTURAL_INDEX_H_
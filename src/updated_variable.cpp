@@ -1,54 +1,66 @@
 #include "updated_variable.h"
 #include "cmd_result_parser.h"
+#include "cmd_result_schema.h"
 
 namespace dbg_mi
 {
 
-bool UpdatedVariable::Parse(ResultValue const &output)
+static bool ConvertInScope(FieldValue const &value, UpdatedVariable::InScope &result)
 {
-    m_new_num_children = -1;
-    wxString str;
-    if(Lookup(output, _T("in_scope"), str))
-    {
-        if(str == _T("true"))
-            m_inscope = InScope_Yes;
-        else if(str == _T("false"))
-            m_inscope = InScope_No;
-        else if(str == _T("invalid"))
-            m_inscope = InScope_Invalid;
-    }
-    else
-        return false;
+    if(value.IsEqual("true"))
+        result = UpdatedVariable::InScope_Yes;
+    else if(value.IsEqual("false"))
+        result = UpdatedVariable::InScope_No;
+    else if(value.IsEqual("invalid"))
+        result = UpdatedVariable::InScope_Invalid;
+    return true;
+}
 
-    if(not Lookup(output, _T("name"), m_name))
-        return false;
+RecordSchema<UpdatedVariable> const & UpdatedVariable::GetSchema()
+{
+    static RecordSchema<UpdatedVariable>::Field const fields[] =
+    {
+        DBG_MI_RECORD_FIELD(UpdatedVariable, in_scope,          m_inscope,          ConvertInScope),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, name,              m_name,             ConvertString),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, type_changed,      m_type_changed,     ConvertBool),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, value,             m_value,            ConvertString),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, new_type,          m_new_type,         ConvertString),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, new_num_children,  m_new_num_children, ConvertInt),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, has_more,          m_has_more,         ConvertFlag),
+        DBG_MI_RECORD_FIELD(UpdatedVariable, dynamic,           m_dynamic,          ConvertFlag)
+    };
+    static RecordSchema<UpdatedVariable> const schema(fields);
+    return schema;
+}
 
-    if(not Lookup(output, _T("type_changed"), m_type_changed))
-        return false;
+bool UpdatedVariable::Parse(ResultValue const &output)
+{
+    return Complete(GetSchema().Decode(output, *this));
+}
 
-    if(Lookup(output, _T("value"), m_value))
+bool UpdatedVariable::Complete(DecodedFields const &fields)
+{
+    if(not fields.Has(Atom_new_num_children))
+        m_new_num_children = -1;
+    if(not fields.Has(Atom_has_more))
+        m_has_more = false;
+    if(not fields.Has(Atom_dynamic))
+        m_dynamic = false;
+    if(fields.Has(Atom_value))
         m_has_value = true;
 
+    if(not fields.Has(Atom_in_scope))
+        return false;
+    if(not fields.Has(Atom_name))
+        return false;
+    if(not fields.Has(Atom_type_changed))
+        return false;
+
     if(m_type_changed)
     {
-        if(not Lookup(output, _T("new_type"), m_new_type))
+        if(not fields.Has(Atom_new_type))
             return false;
     }
-    if(not Lookup(output, _T("new_num_children"), m_new_num_children))
-        m_new_num_children = -1;
-
-    int value;
-    if(Lookup(output, _T("has_more"), value))
-        m_has_more = (value == 1);
-    else
-        m_has_more = false;
-
-    if(Lookup(output, _T("dynamic"), value))
-        m_dynamic = (value == 1);
-    else
-        m_dynamic = false;
-
-
     return true;
 }
 
@@ -76,4 +88,40 @@ wxString UpdatedVariable::MakeDebugString() const
                             m_has_more ? 1 : 0, m_dynamic ? 1 : 0);
 }
 
+RecordSchema<VarObjectInfo> const & VarObjectInfo::GetSchema()
+{
+    static RecordSchema<VarObjectInfo>::Field const fields[] =
+    {
+        DBG_MI_RECORD_FIELD(VarObjectInfo, name,        m_name,             ConvertString),
+        DBG_MI_RECORD_FIELD(VarObjectInfo, exp,         m_expression,       ConvertString),
+        DBG_MI_RECORD_FIELD(VarObjectInfo, value,       m_value,            ConvertString),
+        DBG_MI_RECORD_FIELD(VarObjectInfo, type,        m_type,             ConvertString),
+        DBG_MI_RECORD_FIELD(VarObjectInfo, numchild,    m_children_count,   ConvertInt),
+        DBG_MI_RECORD_FIELD(VarObjectInfo, dynamic,     m_dynamic,          ConvertFlag),
+        DBG_MI_RECORD_FIELD(VarObjectInfo, has_more,    m_has_more,         ConvertFlag)
+    };
+    static RecordSchema<VarObjectInfo> const schema(fields);
+    return schema;
+}
+
+void VarObjectInfo::Parse(ResultValue const &value)
+{
+    Complete(GetSchema().Decode(value, *this));
+}
+
+void VarObjectInfo::Complete(DecodedFields const &fields)
+{
+    if(not fields.Has(Atom_numchild))
+        m_children_count = -1;
+    if(not fields.Has(Atom_dynamic))
+        m_dynamic = false;
+    if(not fields.Has(Atom_has_more))
+        m_has_more = false;
+
+    m_has_name = fields.Has(Atom_name);
+    m_has_expression = fields.Has(Atom_exp);
+    m_has_value = fields.Has(Atom_value);
+    m_has_type = fields.Has(Atom_type);
+}
+
 } // namespace dbg_mi
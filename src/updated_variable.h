@@ -7,6 +7,8 @@ namespace dbg_mi
 {
 
 class ResultValue;
+struct DecodedFields;
+template<typename Record> class RecordSchema;
 
 class UpdatedVariable
 {
@@ -40,6 +42,10 @@ public:
     bool IsDynamic() const { return m_dynamic; }
 
     bool Parse(ResultValue const &output);
+    // Checks the fields decoded with GetSchema() and completes the variable.
+    bool Complete(DecodedFields const &fields);
+
+    static RecordSchema<UpdatedVariable> const & GetSchema();
 
     wxString MakeDebugString() const;
 private:
@@ -54,6 +60,54 @@ private:
     bool m_dynamic;
 };
 
+// A variable object as reported by -var-create, -var-evaluate-expression
+// and the child={...} entries of -var-list-children.
+class VarObjectInfo
+{
+public:
+    VarObjectInfo() :
+        m_children_count(-1),
+        m_dynamic(false),
+        m_has_more(false),
+        m_has_name(false),
+        m_has_expression(false),
+        m_has_value(false),
+        m_has_type(false)
+    {
+    }
+
+    wxString const & GetName() const { return m_name; }
+    wxString const & GetExpression() const { return m_expression; }
+    wxString const & GetValue() const { return m_value; }
+    wxString const & GetType() const { return m_type; }
+    int GetChildrenCount() const { return m_children_count; } // -1 if it is unknown
+    bool IsDynamic() const { return m_dynamic; }
+    bool HasMore() const { return m_has_more; }
+
+    bool HasName() const { return m_has_name; }
+    bool HasExpression() const { return m_has_expression; }
+    bool HasValue() const { return m_has_value; }
+    bool HasType() const { return m_has_type; }
+
+    void Parse(ResultValue const &value);
+    // Completes the info from the fields decoded with GetSchema().
+    void Complete(DecodedFields const &fields);
+
+    static RecordSchema<VarObjectInfo> const & GetSchema();
+private:
+    wxString m_name;
+    wxString m_expression;
+    wxString m_value;
+    wxString m_type;
+    int m_children_count;
+    bool m_dynamic;
+    bool m_has_more;
+    bool m_has_name;
+    bool m_has_expression;
+    bool m_has_value;
+    bool m_has_type;
+};
+
 
 
 } // namespace dbg_mi